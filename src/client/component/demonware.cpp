@@ -10,7 +10,10 @@
 #include "game/demonware/servers/stun_server.hpp"
 #include "game/demonware/servers/umbrella_server.hpp"
 #include "game/demonware/server_registry.hpp"
+#include "game/demonware/latency.hpp"
+#include "game/demonware/user_storage.hpp"
 
+#include "command.hpp"
 #include "localized_strings.hpp"
 
 #define TCP_BLOCKING true
@@ -22,52 +25,233 @@ namespace demonware
 	{
 		std::atomic_bool exit_server{false};
 		std::thread server_thread{};
+		std::mutex server_mutex{};
+		std::condition_variable server_event{};
+		bool server_input{false};
 		utils::concurrency::container<std::unordered_map<SOCKET, bool>> blocking_sockets{};
-		utils::concurrency::container<std::unordered_map<SOCKET, tcp_server*>> socket_map{};
 		server_registry<tcp_server> tcp_servers{};
 		server_registry<udp_server> udp_servers{};
+		lobby_server* lobby{};
 		std::unordered_map<void*, void*> original_imports{};
 
-		tcp_server* find_server(const SOCKET socket)
+		// Sockets connected to an emulated tcp server, select only ever walks these
+		struct linked_socket
+		{
+			std::atomic<SOCKET> socket{INVALID_SOCKET};
+			std::atomic<tcp_server*> server{nullptr};
+		};
+
+		constexpr size_t MAX_LINKED_SOCKETS = 32;
+		std::array<linked_socket, MAX_LINKED_SOCKETS> linked_sockets{};
+
+		// Lock-free classification of every socket the game touches.
+		// Real sockets skip all emulation lookups, sockets that are emulated
+		// (or don't fit into the table) take the regular path.
+		struct socket_entry
 		{
-			return socket_map.access<tcp_server*>([&](const std::unordered_map<SOCKET, tcp_server*>& map) -> tcp_server*
+			std::atomic<SOCKET> socket{INVALID_SOCKET};
+			std::atomic_bool emulated{false};
+			// Last sendto destination that isn't emulated, tagged with bit 32 so 0 means none.
+			// UDP sockets may talk to emulated and real hosts alike, so sends are classified per destination.
+			std::atomic<uint64_t> real_destination{0};
+			std::atomic<uint64_t> fast_calls{0};
+			std::atomic<uint64_t> emulated_calls{0};
+		};
+
+		constexpr size_t MAX_TRACKED_SOCKETS = 0x400;
+		constexpr size_t MAX_SOCKET_PROBES = 0x20;
+
+		// Marks slots of closed sockets, keeps the probe chains behind them intact
+		constexpr SOCKET CLOSED_SOCKET = INVALID_SOCKET - 1;
+
+		std::array<socket_entry, MAX_TRACKED_SOCKETS> socket_table{};
+
+		socket_entry* get_socket_entry(const SOCKET socket, const bool create = true)
+		{
+			if (socket == INVALID_SOCKET || socket == CLOSED_SOCKET)
 			{
-				const auto entry = map.find(socket);
-				if (entry == map.end())
+				return nullptr;
+			}
+
+			// Socket handles are multiples of 4
+			const auto start = static_cast<size_t>(socket >> 2);
+
+			socket_entry* free_entry = nullptr;
+
+			for (size_t i = 0; i < MAX_SOCKET_PROBES; ++i)
+			{
+				auto& entry = socket_table[(start + i) % MAX_TRACKED_SOCKETS];
+
+				const auto current = entry.socket.load(std::memory_order_acquire);
+				if (current == socket)
 				{
-					return nullptr;
+					return &entry;
 				}
 
-				return entry->second;
-			});
+				if (current == CLOSED_SOCKET && !free_entry)
+				{
+					free_entry = &entry;
+				}
+
+				if (current == INVALID_SOCKET)
+				{
+					if (!free_entry)
+					{
+						free_entry = &entry;
+					}
+
+					break;
+				}
+			}
+
+			if (!create || !free_entry)
+			{
+				return nullptr;
+			}
+
+			auto expected = free_entry->socket.load(std::memory_order_acquire);
+			if ((expected == INVALID_SOCKET || expected == CLOSED_SOCKET) &&
+				free_entry->socket.compare_exchange_strong(expected, socket, std::memory_order_acq_rel))
+			{
+				return free_entry;
+			}
+
+			// Lost the slot to another thread
+			return expected == socket ? free_entry : nullptr;
 		}
 
-		bool socket_link(const SOCKET socket, const uint32_t address)
+		void count_socket_call(socket_entry& entry, const bool fast)
 		{
-			auto* server = tcp_servers.find(address);
-			if (!server)
+			(fast ? entry.fast_calls : entry.emulated_calls).fetch_add(1, std::memory_order_relaxed);
+		}
+
+		bool is_real_socket(const SOCKET socket)
+		{
+			auto* entry = get_socket_entry(socket);
+			if (!entry)
 			{
 				return false;
 			}
 
-			socket_map.access([&](std::unordered_map<SOCKET, tcp_server*>& map)
+			const auto real = !entry->emulated.load(std::memory_order_acquire);
+			count_socket_call(*entry, real);
+			return real;
+		}
+
+		void mark_socket_emulated(const SOCKET socket)
+		{
+			if (auto* entry = get_socket_entry(socket))
+			{
+				entry->emulated.store(true, std::memory_order_release);
+			}
+		}
+
+		void release_socket(const SOCKET socket)
+		{
+			if (auto* entry = get_socket_entry(socket, false))
+			{
+				entry->emulated.store(false, std::memory_order_release);
+				entry->real_destination.store(0, std::memory_order_relaxed);
+				entry->fast_calls.store(0, std::memory_order_relaxed);
+				entry->emulated_calls.store(0, std::memory_order_relaxed);
+				entry->socket.store(CLOSED_SOCKET, std::memory_order_release);
+			}
+		}
+
+		bool has_pending_datagrams()
+		{
+			auto pending = false;
+			udp_servers.for_each([&](const udp_server& server)
 			{
-				map[socket] = server;
+				pending |= server.has_pending_data();
 			});
 
-			return true;
+			return pending;
+		}
+
+		void print_socket_stats()
+		{
+			printf("%-20s %-10s %12s %12s\n", "Socket", "Type", "Fast calls", "Emulated");
+
+			for (const auto& entry : socket_table)
+			{
+				const auto socket = entry.socket.load(std::memory_order_acquire);
+				const auto fast_calls = entry.fast_calls.load(std::memory_order_relaxed);
+				const auto emulated_calls = entry.emulated_calls.load(std::memory_order_relaxed);
+
+				if (socket == INVALID_SOCKET || socket == CLOSED_SOCKET || (!fast_calls && !emulated_calls))
+				{
+					continue;
+				}
+
+				printf("%-20llu %-10s %12llu %12llu\n", static_cast<unsigned long long>(socket),
+				       entry.emulated.load(std::memory_order_relaxed) ? "emulated" : "real", fast_calls,
+				       emulated_calls);
+			}
+		}
+
+		tcp_server* find_server(const SOCKET socket)
+		{
+			if (is_real_socket(socket))
+			{
+				return nullptr;
+			}
+
+			for (const auto& linked : linked_sockets)
+			{
+				if (linked.socket.load(std::memory_order_acquire) == socket)
+				{
+					return linked.server.load(std::memory_order_acquire);
+				}
+			}
+
+			return nullptr;
 		}
 
 		void socket_unlink(const SOCKET socket)
 		{
-			socket_map.access([&](std::unordered_map<SOCKET, tcp_server*>& map)
+			for (auto& linked : linked_sockets)
 			{
-				const auto entry = map.find(socket);
-				if (entry != map.end())
+				if (linked.socket.load(std::memory_order_acquire) == socket)
 				{
-					map.erase(entry);
+					// Hide the socket first, the slot is free again once the server is cleared
+					linked.socket.store(INVALID_SOCKET, std::memory_order_release);
+					linked.server.store(nullptr, std::memory_order_release);
 				}
-			});
+			}
+		}
+
+		bool socket_link(const SOCKET socket, const uint32_t address)
+		{
+			auto* server = tcp_servers.find(address);
+			if (!server)
+			{
+				return false;
+			}
+
+			socket_unlink(socket);
+
+			for (auto& linked : linked_sockets)
+			{
+				// Slots are claimed through the server, the socket is published last
+				// so readers never see a linked socket without its server
+				tcp_server* expected = nullptr;
+				if (!linked.server.compare_exchange_strong(expected, server, std::memory_order_acq_rel))
+				{
+					continue;
+				}
+
+				// A new connection starts a new stream
+				server->reset_input();
+				mark_socket_emulated(socket);
+
+				linked.socket.store(socket, std::memory_order_release);
+				return true;
+			}
+
+			printf("[DW]: Too many connections to emulated servers, can't link socket %llu\n",
+			       static_cast<unsigned long long>(socket));
+			return false;
 		}
 
 		bool is_socket_blocking(const SOCKET socket, const bool def)
@@ -104,6 +288,16 @@ namespace demonware
 			});
 		}
 
+		void wake_server()
+		{
+			{
+				std::lock_guard<std::mutex> _(server_mutex);
+				server_input = true;
+			}
+
+			server_event.notify_one();
+		}
+
 		void server_main()
 		{
 			exit_server = false;
@@ -112,7 +306,14 @@ namespace demonware
 			{
 				tcp_servers.frame();
 				udp_servers.frame();
-				std::this_thread::sleep_for(50ms);
+
+				std::unique_lock<std::mutex> lock(server_mutex);
+				server_event.wait_for(lock, 50ms, []
+				{
+					return server_input || exit_server;
+				});
+
+				server_input = false;
 			}
 		}
 
@@ -254,6 +455,7 @@ namespace demonware
 			{
 				remove_blocking_socket(s);
 				socket_unlink(s);
+				release_socket(s);
 
 				return closesocket(s);
 			}
@@ -292,20 +494,47 @@ namespace demonware
 			                const int tolen)
 			{
 				const auto* in_addr = reinterpret_cast<const sockaddr_in*>(to);
+				const auto destination = (1ull << 32) | in_addr->sin_addr.s_addr;
+
+				auto* entry = get_socket_entry(s);
+				if (entry && entry->real_destination.load(std::memory_order_relaxed) == destination)
+				{
+					count_socket_call(*entry, true);
+					return sendto(s, buf, len, flags, to, tolen);
+				}
+
 				auto* server = udp_servers.find(in_addr->sin_addr.s_addr);
 
 				if (server)
 				{
+					if (entry) count_socket_call(*entry, false);
 					server->handle_input(buf, len, {s, to, tolen});
 					return len;
 				}
 
+				if (entry)
+				{
+					entry->real_destination.store(destination, std::memory_order_relaxed);
+					count_socket_call(*entry, true);
+				}
+
 				return sendto(s, buf, len, flags, to, tolen);
 			}
 
 			int recvfrom_stub(const SOCKET s, char* buf, const int len, const int flags, struct sockaddr* from,
 			                  int* fromlen)
 			{
+				auto* entry = get_socket_entry(s);
+
+				// Emulated replies are only looked for while one is queued
+				if (!has_pending_datagrams())
+				{
+					if (entry) count_socket_call(*entry, true);
+					return recvfrom(s, buf, len, flags, from, fromlen);
+				}
+
+				if (entry) count_socket_call(*entry, false);
+
 				// Not supported yet
 				if (is_socket_blocking(s, UDP_BLOCKING))
 				{
@@ -338,44 +567,37 @@ namespace demonware
 					return select(nfds, readfds, writefds, exceptfds, timeout);
 				}
 
-				auto result = 0;
-				std::vector<SOCKET> read_sockets;
-				std::vector<SOCKET> write_sockets;
+				SOCKET read_sockets[MAX_LINKED_SOCKETS];
+				SOCKET write_sockets[MAX_LINKED_SOCKETS];
+				size_t read_count = 0;
+				size_t write_count = 0;
 
-				socket_map.access([&](std::unordered_map<SOCKET, tcp_server*>& sockets)
+				for (const auto& linked : linked_sockets)
 				{
-					for (auto& s : sockets)
+					const auto socket = linked.socket.load(std::memory_order_acquire);
+					const auto* server = linked.server.load(std::memory_order_acquire);
+					if (socket == INVALID_SOCKET || !server)
 					{
-						if (readfds)
-						{
-							if (FD_ISSET(s.first, readfds))
-							{
-								if (s.second->pending_data())
-								{
-									read_sockets.push_back(s.first);
-									FD_CLR(s.first, readfds);
-								}
-							}
-						}
-
-						if (writefds)
-						{
-							if (FD_ISSET(s.first, writefds))
-							{
-								write_sockets.push_back(s.first);
-								FD_CLR(s.first, writefds);
-							}
-						}
-
-						if (exceptfds)
-						{
-							if (FD_ISSET(s.first, exceptfds))
-							{
-								FD_CLR(s.first, exceptfds);
-							}
-						}
+						continue;
 					}
-				});
+
+					if (readfds && FD_ISSET(socket, readfds) && server->pending_data())
+					{
+						read_sockets[read_count++] = socket;
+						FD_CLR(socket, readfds);
+					}
+
+					if (writefds && FD_ISSET(socket, writefds))
+					{
+						write_sockets[write_count++] = socket;
+						FD_CLR(socket, writefds);
+					}
+
+					if (exceptfds && FD_ISSET(socket, exceptfds))
+					{
+						FD_CLR(socket, exceptfds);
+					}
+				}
 
 				if ((!readfds || readfds->fd_count == 0) && (!writefds || writefds->fd_count == 0))
 				{
@@ -383,25 +605,19 @@ namespace demonware
 					timeout->tv_usec = 0;
 				}
 
-				result = select(nfds, readfds, writefds, exceptfds, timeout);
+				auto result = select(nfds, readfds, writefds, exceptfds, timeout);
 				if (result < 0) result = 0;
 
-				for (const auto& socket : read_sockets)
+				for (size_t i = 0; i < read_count; ++i)
 				{
-					if (readfds)
-					{
-						FD_SET(socket, readfds);
-						result++;
-					}
+					FD_SET(read_sockets[i], readfds);
+					result++;
 				}
 
-				for (const auto& socket : write_sockets)
+				for (size_t i = 0; i < write_count; ++i)
 				{
-					if (writefds)
-					{
-						FD_SET(socket, writefds);
-						result++;
-					}
+					FD_SET(write_sockets[i], writefds);
+					result++;
 				}
 
 				return result;
@@ -450,8 +666,18 @@ namespace demonware
 			udp_servers.create<stun_server>("stun.au.demonware.net");
 
 			tcp_servers.create<auth3_server>("ops3-pc-auth3.prod.demonware.net");
-			tcp_servers.create<lobby_server>("ops3-pc-lobby.prod.demonware.net");
+			lobby = &tcp_servers.create<lobby_server>("ops3-pc-lobby.prod.demonware.net");
 			tcp_servers.create<umbrella_server>("prod.umbrella.demonware.net");
+
+			tcp_servers.for_each([](tcp_server& server)
+			{
+				server.set_input_notifier(wake_server);
+			});
+
+			udp_servers.for_each([](udp_server& server)
+			{
+				server.set_input_notifier(wake_server);
+			});
 		}
 
 		void post_load() override
@@ -474,6 +700,36 @@ namespace demonware
 		void post_unpack() override
 		{
 			server_thread = utils::thread::create_named_thread("Demonware", server_main);
+			user_storage::start();
+
+			command::add("dw_latency", [](const command::params& params)
+			{
+				if (params.size() > 1 && params[1] == "reset"s)
+				{
+					latency::reset();
+					return;
+				}
+
+				latency::print();
+			});
+
+			command::add("dw_storage", []
+			{
+				user_storage::print_stats();
+			});
+
+			command::add("dw_sockets", print_socket_stats);
+
+			command::add("dw_stats", [](const command::params& params)
+			{
+				if (params.size() > 1 && params[1] == "reset"s)
+				{
+					lobby->reset_stats();
+					return;
+				}
+
+				lobby->print_stats();
+			});
 
 			utils::hook::set<uint8_t>(game::select(0x14293DC69, 0x1407D5879), 0x0); // CURLOPT_SSL_VERIFYPEER
 			utils::hook::set<uint8_t>(game::select(0x15C293850, 0x1407D5865), 0xAF); // CURLOPT_SSL_VERIFYHOST
@@ -503,11 +759,15 @@ namespace demonware
 		void pre_destroy() override
 		{
 			exit_server = true;
+			wake_server();
+
 			if (server_thread.joinable())
 			{
 				server_thread.join();
 			}
 
+			user_storage::stop();
+
 			for (const auto& import : original_imports)
 			{
 				utils::hook::set(import.first, import.second);
@@ -4,15 +4,177 @@
 #include "game/game.hpp"
 #include "game/utils.hpp"
 
+#include "game_event.hpp"
+
 #include <utils/hook.hpp>
 #include <utils/string.hpp>
 #include <utils/io.hpp>
+#include <utils/thread.hpp>
+#include <utils/concurrency.hpp>
 
 namespace game_log
 {
 	namespace
 	{
 		const game::dvar_t* g_log;
+		const game::dvar_t* g_log_rotate_size;
+		const game::dvar_t* g_log_rotate_time;
+
+		// Lines are written by the log thread once this much is pending or the interval elapsed
+		constexpr size_t log_flush_size = 64 * 1024;
+		constexpr auto log_flush_interval = 1s;
+
+		struct log_buffer
+		{
+			std::string file{};
+			std::string data{};
+		};
+
+		struct log_writer
+		{
+			std::string file{};
+			std::string pending{};
+			std::ofstream stream{};
+			size_t size{0};
+			std::chrono::system_clock::time_point opened{};
+		};
+
+		utils::concurrency::container<log_buffer> buffer{};
+		utils::concurrency::container<log_writer> writer{};
+
+		std::condition_variable flush_event{};
+		std::atomic_bool kill_thread{false};
+		std::thread log_thread{};
+
+		void open_log(log_writer& w, const std::string& file)
+		{
+			w.stream.close();
+			w.stream.clear();
+
+			const auto parent = std::filesystem::path(file).parent_path();
+			if (!parent.empty())
+			{
+				utils::io::create_directory(parent);
+			}
+
+			w.file = file;
+			w.size = utils::io::file_exists(file) ? utils::io::file_size(file) : 0;
+			w.opened = std::chrono::system_clock::now();
+			w.stream.open(file, std::ios::binary | std::ios::app);
+		}
+
+		bool should_rotate(const log_writer& w)
+		{
+			const auto max_size = g_log_rotate_size ? g_log_rotate_size->current.value.integer : 0;
+			if (max_size > 0 && w.size >= static_cast<size_t>(max_size) * 1024 * 1024)
+			{
+				return true;
+			}
+
+			const auto max_age = g_log_rotate_time ? g_log_rotate_time->current.value.integer : 0;
+			return max_age > 0 && std::chrono::system_clock::now() - w.opened >= std::chrono::minutes(max_age);
+		}
+
+		void rotate_log(log_writer& w)
+		{
+			const auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+			tm time_info{};
+			localtime_s(&time_info, &time);
+
+			char time_buffer[32]{};
+			std::strftime(time_buffer, sizeof(time_buffer), "%Y%m%d-%H%M%S", &time_info);
+
+			w.stream.close();
+			utils::io::move_file(w.file, w.file + "." + time_buffer);
+			open_log(w, w.file);
+		}
+
+		void flush_log()
+		{
+			// The writer lock is held while taking the buffer so concurrent flushes keep lines in order
+			writer.access([](log_writer& w)
+			{
+				std::string file{};
+
+				w.pending.clear();
+				buffer.access([&](log_buffer& b)
+				{
+					std::swap(w.pending, b.data);
+					file = b.file;
+				});
+
+				if (w.pending.empty())
+				{
+					return;
+				}
+
+				if (!w.stream.is_open() || w.file != file)
+				{
+					open_log(w, file);
+				}
+				else if (should_rotate(w))
+				{
+					rotate_log(w);
+				}
+
+				w.stream.write(w.pending.data(), static_cast<std::streamsize>(w.pending.size()));
+				w.stream.flush();
+				w.size += w.pending.size();
+			});
+		}
+
+		void close_log()
+		{
+			flush_log();
+
+			writer.access([](log_writer& w)
+			{
+				w.stream.close();
+			});
+		}
+
+		void log_thread_main()
+		{
+			while (!kill_thread)
+			{
+				buffer.access_with_lock([](const log_buffer& b, std::unique_lock<std::mutex>& lock)
+				{
+					flush_event.wait_for(lock, log_flush_interval, [&b]
+					{
+						return kill_thread || b.data.size() >= log_flush_size;
+					});
+				});
+
+				flush_log();
+			}
+		}
+
+		void append_log(const std::string& file, const std::string_view& line)
+		{
+			const auto file_changed = buffer.access<bool>([&](const log_buffer& b)
+			{
+				return !b.data.empty() && b.file != file;
+			});
+
+			// Lines queued for the previous g_log path have to land there first
+			if (file_changed)
+			{
+				flush_log();
+			}
+
+			const auto pending = buffer.access<size_t>([&](log_buffer& b)
+			{
+				b.file = file;
+				b.data.append(line);
+				return b.data.size();
+			});
+
+			if (pending >= log_flush_size)
+			{
+				flush_event.notify_one();
+			}
+		}
 
 		void g_scr_log_print()
 		{
@@ -50,12 +212,12 @@ namespace game_log
 			const auto* file = g_log ? g_log->current.value.string : "games_mp.log";
 			const auto time = *game::level_time / 1000;
 
-			utils::io::write_file(file, utils::string::va("%3i:%i%i %s",
-			                                              time / 60,
-			                                              time % 60 / 10,
-			                                              time % 60 % 10,
-			                                              va_buffer
-			                      ), true);
+			append_log(file, utils::string::va("%3i:%i%i %s",
+			                                   time / 60,
+			                                   time % 60 / 10,
+			                                   time % 60 % 10,
+			                                   va_buffer
+			           ));
 		}
 
 		const game::dvar_t* register_g_log_stub()
@@ -78,6 +240,28 @@ namespace game_log
 
 			// G_InitGame: because we changed the dvar g_log from a bool dvar to a string dvar we need to skip a bunch of related code to force it
 			utils::hook::jump(0x1402AC00E_g, 0x1402AC061_g, true);
+
+			g_log_rotate_size = game::register_dvar_int("g_log_rotate_size", 0, 0, 1024, game::DVAR_NONE,
+			                                            "Rotate the log file once it reaches this size in MB (0 = disabled)");
+			g_log_rotate_time = game::register_dvar_int("g_log_rotate_time", 0, 0, 10080, game::DVAR_NONE,
+			                                            "Rotate the log file after this many minutes (0 = disabled)");
+
+			game_event::on_g_shutdown_game(flush_log);
+
+			log_thread = utils::thread::create_named_thread("Game Log", log_thread_main);
+		}
+
+		void pre_destroy() override
+		{
+			kill_thread = true;
+			flush_event.notify_all();
+
+			if (log_thread.joinable())
+			{
+				log_thread.join();
+			}
+
+			close_log();
 		}
 	};
 }
@@ -4,6 +4,7 @@
 #include "game/game.hpp"
 #include "steam/steam.hpp"
 
+#include "game_event.hpp"
 #include "network.hpp"
 #include "workshop.hpp"
 
@@ -78,45 +79,184 @@ namespace getinfo
 		return game::SV_Loaded() && (game::is_server() || !game::Com_IsRunningUILevel());
 	}
 
+	namespace
+	{
+		using clock = std::chrono::high_resolution_clock;
+
+		// Sustained getInfo queries per second and burst size accepted from a single address
+		constexpr double query_rate = 5.0;
+		constexpr double query_burst = 20.0;
+
+		// Addresses tracked at once, queries from new addresses are dropped while the table is full
+		constexpr size_t max_query_limits = 4096;
+
+		struct query_limit
+		{
+			double tokens{query_burst};
+			clock::time_point last_query{};
+		};
+
+		std::unordered_map<uint32_t, query_limit> query_limits{};
+		clock::time_point last_limit_cleanup{};
+
+		// Changes without an event to hook, like dvars set by rcon or dropped clients
+		// being freed, are picked up once the cached response has expired
+		constexpr auto info_lifetime = 1s;
+
+		struct info_cache
+		{
+			std::string body{};
+			clock::time_point built{};
+		};
+
+		info_cache cached_info{};
+		std::atomic_bool info_outdated{true};
+
+		utils::hook::detour sv_direct_connect_hook;
+		utils::hook::detour sv_drop_client_hook;
+
+		void invalidate_info()
+		{
+			info_outdated = true;
+		}
+
+		void sv_direct_connect_stub(const game::netadr_t from)
+		{
+			sv_direct_connect_hook.invoke(from);
+			invalidate_info();
+		}
+
+		void sv_drop_client_stub(void* drop, const char* reason, const bool tell_them, const bool remove_from_lobby)
+		{
+			sv_drop_client_hook.invoke(drop, reason, tell_them, remove_from_lobby);
+			invalidate_info();
+		}
+
+		void cleanup_query_limits(const clock::time_point now)
+		{
+			// Idle addresses have a full bucket again, so their entries can be dropped
+			last_limit_cleanup = now;
+			std::erase_if(query_limits, [&now](const auto& entry)
+			{
+				return (now - entry.second.last_query) >= 10s;
+			});
+		}
+
+		bool is_rate_limited(const game::netadr_t& target)
+		{
+			if (target.type != game::NA_IP && target.type != game::NA_RAWIP)
+			{
+				return false;
+			}
+
+			const auto now = clock::now();
+			if ((now - last_limit_cleanup) >= 10s)
+			{
+				cleanup_query_limits(now);
+			}
+
+			auto entry = query_limits.find(target.addr);
+			if (entry == query_limits.end())
+			{
+				if (query_limits.size() >= max_query_limits)
+				{
+					cleanup_query_limits(now);
+					if (query_limits.size() >= max_query_limits)
+					{
+						return true;
+					}
+				}
+
+				entry = query_limits.emplace(target.addr, query_limit{}).first;
+			}
+
+			auto& limit = entry->second;
+
+			const auto elapsed = std::chrono::duration<double>(now - limit.last_query).count();
+			limit.tokens = std::min(query_burst, limit.tokens + elapsed * query_rate);
+			limit.last_query = now;
+
+			if (limit.tokens < 1.0)
+			{
+				return true;
+			}
+
+			limit.tokens -= 1.0;
+			return false;
+		}
+
+		std::string build_info()
+		{
+			utils::info_string info{};
+			info.set("gamename", "T7");
+			info.set("hostname",
+			         game::get_dvar_string(game::is_server() ? "live_steam_server_name" : "sv_hostname"));
+			info.set("gametype", game::get_dvar_string("g_gametype"));
+			//info.set("sv_motd", get_dvar_string("sv_motd"));
+			info.set("description",
+			         game::is_server() ? game::get_dvar_string("live_steam_server_description") : "");
+			info.set("xuid", utils::string::va("%llX", steam::SteamUser()->GetSteamID().bits));
+			info.set("mapname", game::get_dvar_string("mapname"));
+			info.set("isPrivate", game::get_dvar_string("g_password").empty() ? "0" : "1");
+			info.set("clients", std::to_string(get_client_count()));
+			info.set("bots", std::to_string(get_bot_count()));
+			info.set("sv_maxclients", std::to_string(get_max_client_count()));
+			info.set("protocol", std::to_string(PROTOCOL));
+			info.set("sub_protocol", std::to_string(SUB_PROTOCOL));
+			info.set("playmode", std::to_string(game::Com_SessionMode_GetMode()));
+			info.set("gamemode", std::to_string(game::Com_SessionMode_GetGameMode()));
+			info.set("sv_running", std::to_string(game::is_server_running()));
+			info.set("dedicated", game::is_server() ? "1" : "0");
+			info.set("hc", std::to_string(game::Com_GametypeSettings_GetUInt("hardcoremode", false)));
+			info.set("modName", workshop::get_mod_resized_name());
+			info.set("modId", workshop::get_mod_publisher_id());
+			info.set("rounds_played", std::to_string(*game::level_rounds_played));
+			info.set("shortversion", SHORTVERSION);
+
+			info.set("sv_wwwBaseURL", game::get_dvar_string("sv_wwwBaseURL"));
+			info.set("workshop_id", game::get_dvar_string("workshop_id"));
+
+			return info.build();
+		}
+
+		// The response without the challenge is rebuilt when the game state it reflects has changed
+		const std::string& get_info()
+		{
+			const auto now = clock::now();
+			if (info_outdated.exchange(false) || (now - cached_info.built) >= info_lifetime)
+			{
+				cached_info.body = build_info();
+				cached_info.built = now;
+			}
+
+			return cached_info.body;
+		}
+	}
+
 	struct component final : generic_component
 	{
 		void post_unpack() override
 		{
 			//utils::hook::jump(game::select(0x142254EF0, 0x140537730), get_assigned_team);
 
+			// Map, gametype and client changes invalidate the cached response right away
+			game_event::on_g_init_game(invalidate_info);
+			game_event::on_g_shutdown_game(invalidate_info);
+			sv_direct_connect_hook.create(game::SV_DirectConnect, sv_direct_connect_stub);
+			sv_drop_client_hook.create(game::SV_DropClient, sv_drop_client_stub);
+
 			network::on("getInfo", [](const game::netadr_t& target, const network::data_view& data)
 			{
-				utils::info_string info{};
-				info.set("challenge", std::string{data.begin(), data.end()});
-				info.set("gamename", "T7");
-				info.set("hostname",
-				         game::get_dvar_string(game::is_server() ? "live_steam_server_name" : "sv_hostname"));
-				info.set("gametype", game::get_dvar_string("g_gametype"));
-				//info.set("sv_motd", get_dvar_string("sv_motd"));
-				info.set("description",
-				         game::is_server() ? game::get_dvar_string("live_steam_server_description") : "");
-				info.set("xuid", utils::string::va("%llX", steam::SteamUser()->GetSteamID().bits));
-				info.set("mapname", game::get_dvar_string("mapname"));
-				info.set("isPrivate", game::get_dvar_string("g_password").empty() ? "0" : "1");
-				info.set("clients", std::to_string(get_client_count()));
-				info.set("bots", std::to_string(get_bot_count()));
-				info.set("sv_maxclients", std::to_string(get_max_client_count()));
-				info.set("protocol", std::to_string(PROTOCOL));
-				info.set("sub_protocol", std::to_string(SUB_PROTOCOL));
-				info.set("playmode", std::to_string(game::Com_SessionMode_GetMode()));
-				info.set("gamemode", std::to_string(game::Com_SessionMode_GetGameMode()));
-				info.set("sv_running", std::to_string(game::is_server_running()));
-				info.set("dedicated", game::is_server() ? "1" : "0");
-				info.set("hc", std::to_string(game::Com_GametypeSettings_GetUInt("hardcoremode", false)));
-				info.set("modName", workshop::get_mod_resized_name());
-				info.set("modId", workshop::get_mod_publisher_id());
-				info.set("rounds_played", std::to_string(*game::level_rounds_played));
-				info.set("shortversion", SHORTVERSION);
-
-				info.set("sv_wwwBaseURL", game::get_dvar_string("sv_wwwBaseURL"));
-				info.set("workshop_id", game::get_dvar_string("workshop_id"));
-
-				network::send(target, "infoResponse", info.build(), '\n');
+				if (is_rate_limited(target))
+				{
+					return;
+				}
+
+				std::string response = "\\challenge\\";
+				response.append(data.begin(), data.end());
+				response.append(get_info());
+
+				network::send(target, "infoResponse", response, '\n');
 			});
 		}
 	};
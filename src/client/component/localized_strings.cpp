@@ -1,9 +1,8 @@
 #include <std_include.hpp>
 #include "loader/component_loader.hpp"
 #include "localized_strings.hpp"
+#include "command.hpp"
 #include <utils/hook.hpp>
-#include <utils/string.hpp>
-#include <utils/concurrency.hpp>
 #include "game/game.hpp"
 
 namespace localized_strings
@@ -12,30 +11,74 @@ namespace localized_strings
 	{
 		utils::hook::detour seh_string_ed_get_string_hook;
 
-		using localized_map = std::unordered_map<std::string, std::string>;
-		utils::concurrency::container<localized_map> localized_overrides;
+		struct string_hash
+		{
+			using is_transparent = void;
+
+			size_t operator()(const std::string_view& value) const
+			{
+				return std::hash<std::string_view>{}(value);
+			}
+		};
+
+		using localized_map = std::unordered_map<std::string, const std::string*, string_hash, std::equal_to<>>;
+
+		// Values are never freed, so returned strings stay valid after the next override.
+		// Snapshots only reference them and are released once no lookup holds them anymore.
+		std::mutex override_mutex;
+		std::deque<std::string> values;
+		std::atomic<std::shared_ptr<const localized_map>> localized_overrides{};
+
+		std::atomic<uint64_t> lookup_count{0};
+		std::atomic<uint64_t> hit_count{0};
 
 		const char* seh_string_ed_get_string(const char* reference)
 		{
-			return localized_overrides.access<const char*>([&](const localized_map& map)
+			lookup_count.fetch_add(1, std::memory_order_relaxed);
+
+			const auto map = localized_overrides.load(std::memory_order_acquire);
+			if (map)
 			{
-				const auto entry = map.find(reference);
-				if (entry != map.end())
+				const auto entry = map->find(std::string_view(reference));
+				if (entry != map->end())
 				{
-					return utils::string::va("%s", entry->second.data());
+					hit_count.fetch_add(1, std::memory_order_relaxed);
+					return entry->second->data();
 				}
+			}
+
+			return seh_string_ed_get_string_hook.invoke<const char*>(reference);
+		}
 
-				return seh_string_ed_get_string_hook.invoke<const char*>(reference);
-			});
+		void print_stats()
+		{
+			const auto map = localized_overrides.load(std::memory_order_acquire);
+
+			printf("Localized strings: %zu overrides, %llu lookups, %llu hits\n", map ? map->size() : 0,
+			       lookup_count.load(std::memory_order_relaxed), hit_count.load(std::memory_order_relaxed));
 		}
 	}
 
 	void override(const std::string& key, const std::string& value)
 	{
-		localized_overrides.access([&](localized_map& map)
+		std::lock_guard _(override_mutex);
+
+		const auto current = localized_overrides.load(std::memory_order_relaxed);
+		if (current)
 		{
-			map[key] = value;
-		});
+			const auto entry = current->find(key);
+			if (entry != current->end() && *entry->second == value)
+			{
+				return;
+			}
+		}
+
+		const auto& stored_value = values.emplace_back(value);
+
+		auto map = current ? std::make_shared<localized_map>(*current) : std::make_shared<localized_map>();
+		(*map)[key] = &stored_value;
+
+		localized_overrides.store(std::move(map), std::memory_order_release);
 	}
 
 	class component final : public client_component
@@ -45,6 +88,8 @@ namespace localized_strings
 		{
 			// Change some localized strings
 			seh_string_ed_get_string_hook.create(0x1422796E0_g, &seh_string_ed_get_string);
+
+			command::add("localized_stats", print_stats);
 		}
 	};
 }
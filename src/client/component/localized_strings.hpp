@@ -2,5 +2,7 @@
 
 namespace localized_strings
 {
+	// Every call copies the override table and keeps the value alive for good,
+	// meant for a fixed set of strings rather than values that change at runtime
 	void override(const std::string& key, const std::string& value);
 }
@@ -4,6 +4,7 @@
 
 #include "party.hpp"
 #include "auth.hpp"
+#include "command.hpp"
 #include "network.hpp"
 #include "scheduler.hpp"
 #include "workshop.hpp"
@@ -22,18 +23,82 @@ namespace party
 		std::atomic_bool is_connecting_to_dedi{false};
 		game::netadr_t connect_host{{}, {}, game::NA_BAD, {}};
 
+		using query_clock = std::chrono::high_resolution_clock;
+
+		constexpr auto query_timeout = 1s;
+
+		// Send rate bounds in queries per second, the lower bound matches the former 40 queries per 100ms tick
+		constexpr double min_query_rate = 400.0;
+		constexpr double max_query_rate = 4000.0;
+		constexpr double query_rate_step = 200.0;
+
 		struct server_query
 		{
-			bool sent{false};
 			game::netadr_t host{};
 			std::string challenge{};
 			query_callback callback{};
-			std::chrono::high_resolution_clock::time_point query_time{};
+			query_clock::time_point query_time{};
+		};
+
+		struct query_key
+		{
+			game::netadr_t host{};
+			std::string challenge{};
+
+			bool operator==(const query_key& other) const
+			{
+				return this->host == other.host && this->challenge == other.challenge;
+			}
 		};
 
-		utils::concurrency::container<std::vector<server_query>>& get_server_queries()
+		struct query_key_hash
 		{
-			static utils::concurrency::container<std::vector<server_query>> server_queries;
+			size_t operator()(const query_key& key) const noexcept
+			{
+				return std::hash<game::netadr_t>()(key.host) ^ (std::hash<std::string>()(key.challenge) << 1);
+			}
+		};
+
+		struct query_timeout_entry
+		{
+			query_clock::time_point deadline{};
+			query_key key{};
+		};
+
+		struct query_stats
+		{
+			uint64_t sent{0};
+			uint64_t responded{0};
+			uint64_t timed_out{0};
+
+			// Completions since the send rate was last adjusted
+			uint64_t window_responded{0};
+			uint64_t window_timed_out{0};
+			query_clock::time_point window_start{};
+
+			// RTT buckets: <=25ms, <=50ms, <=100ms, <=200ms, <=400ms, above
+			std::array<uint64_t, 6> rtt_buckets{};
+			std::chrono::milliseconds rtt_total{};
+		};
+
+		struct query_engine
+		{
+			std::deque<server_query> pending{};
+			std::unordered_map<query_key, server_query, query_key_hash> in_flight{};
+
+			// All queries share the same timeout, so ordering by send time keeps the queue sorted by deadline
+			std::deque<query_timeout_entry> timeouts{};
+
+			double rate{min_query_rate};
+			double tokens{0.0};
+			query_clock::time_point last_refill{};
+
+			query_stats stats{};
+		};
+
+		utils::concurrency::container<query_engine>& get_server_queries()
+		{
+			static utils::concurrency::container<query_engine> server_queries;
 			return server_queries;
 		}
 
@@ -173,7 +238,7 @@ namespace party
 				return;
 			}
 
-			const auto mapname = info.get("mapname");
+			const std::string mapname{info.get("mapname")};
 			if (mapname.empty())
 			{
 				const auto str = "Invalid map.";
@@ -181,7 +246,7 @@ namespace party
 				return;
 			}
 
-			const auto gametype = info.get("gametype");
+			const std::string gametype{info.get("gametype")};
 			if (gametype.empty())
 			{
 				const auto str = "Invalid gametype.";
@@ -189,9 +254,9 @@ namespace party
 				return;
 			}
 
-			const auto mod_id = info.get("modId");
+			const std::string mod_id{info.get("modId")};
 
-			const auto workshop_id = info.get("workshop_id"); //check workshop_id dvar for id
+			const std::string workshop_id{info.get("workshop_id")}; //check workshop_id dvar for id
 
 			//const auto hostname = info.get("sv_hostname");
 			const auto playmode = info.get("playmode");
@@ -233,42 +298,104 @@ namespace party
 			query_server(connect_host, handle_connect_query_response);
 		}
 
-		void send_server_query(server_query& query)
+		void record_rtt(query_stats& stats, const std::chrono::milliseconds rtt)
+		{
+			constexpr std::array<std::chrono::milliseconds, 5> limits{25ms, 50ms, 100ms, 200ms, 400ms};
+
+			size_t bucket = 0;
+			while (bucket < limits.size() && rtt > limits[bucket])
+			{
+				++bucket;
+			}
+
+			++stats.rtt_buckets[bucket];
+			stats.rtt_total += rtt;
+		}
+
+		void adjust_query_rate(query_engine& engine, const query_clock::time_point now)
 		{
-			query.sent = true;
-			query.query_time = std::chrono::high_resolution_clock::now();
-			query.challenge = utils::cryptography::random::get_challenge();
+			auto& stats = engine.stats;
+			const auto completed = stats.window_responded + stats.window_timed_out;
+			if ((now - stats.window_start) < 1s || completed < 20)
+			{
+				return;
+			}
 
-			network::send(query.host, "getInfo", query.challenge);
+			// Back off multiplicatively when queries get lost, probe upwards additively otherwise
+			const auto loss = static_cast<double>(stats.window_timed_out) / static_cast<double>(completed);
+			if (loss > 0.1)
+			{
+				engine.rate = std::max(min_query_rate, engine.rate * 0.7);
+			}
+			else if (loss < 0.02)
+			{
+				engine.rate = std::min(max_query_rate, engine.rate + query_rate_step);
+			}
+
+			stats.window_responded = 0;
+			stats.window_timed_out = 0;
+			stats.window_start = now;
+		}
+
+		void send_pending_queries(query_engine& engine, const query_clock::time_point now)
+		{
+			const auto elapsed = std::chrono::duration<double>(now - engine.last_refill).count();
+			engine.last_refill = now;
+
+			// Allow bursts of up to 100ms worth of queries
+			const auto capacity = engine.rate / 10.0;
+			engine.tokens = std::min(capacity, engine.tokens + engine.rate * elapsed);
+
+			while (engine.tokens >= 1.0 && !engine.pending.empty())
+			{
+				auto query = std::move(engine.pending.front());
+				engine.pending.pop_front();
+
+				query.query_time = now;
+				query.challenge = utils::cryptography::random::get_challenge();
+
+				network::send(query.host, "getInfo", query.challenge);
+
+				query_key key{query.host, query.challenge};
+				engine.timeouts.emplace_back(query_timeout_entry{now + query_timeout, key});
+				engine.in_flight.emplace(std::move(key), std::move(query));
+
+				engine.tokens -= 1.0;
+				++engine.stats.sent;
+			}
 		}
 
 		void handle_info_response(const game::netadr_t& target, const network::data_view& data)
 		{
-			bool found_query = false;
-			server_query query{};
+			std::optional<server_query> query{};
 
 			const utils::info_string info{data};
 
-			get_server_queries().access([&](std::vector<server_query>& server_queries)
+			get_server_queries().access([&](query_engine& engine)
 			{
-				for (auto i = server_queries.begin(); i != server_queries.end(); ++i)
+				const auto entry = engine.in_flight.find(query_key{target, std::string{info.get("challenge")}});
+				if (entry == engine.in_flight.end())
 				{
-					if (i->host == target && i->challenge == info.get("challenge"))
-					{
-						found_query = true;
-						query = std::move(*i);
-						i = server_queries.erase(i);
-						break;
-					}
+					return;
 				}
+
+				query.emplace(std::move(entry->second));
+				engine.in_flight.erase(entry);
 			});
 
-			if (found_query)
+			if (query)
 			{
-				const auto ping = std::chrono::high_resolution_clock::now() - query.query_time;
-				const auto ping_ms = std::chrono::duration_cast<std::chrono::milliseconds>(ping).count();
+				const auto ping = query_clock::now() - query->query_time;
+				const auto ping_ms = std::chrono::duration_cast<std::chrono::milliseconds>(ping);
 
-				query.callback(true, query.host, info, static_cast<uint32_t>(ping_ms));
+				get_server_queries().access([&](query_engine& engine)
+				{
+					++engine.stats.responded;
+					++engine.stats.window_responded;
+					record_rtt(engine.stats, ping_ms);
+				});
+
+				query->callback(true, query->host, info, static_cast<uint32_t>(ping_ms.count()));
 			}
 		}
 
@@ -276,33 +403,28 @@ namespace party
 		{
 			std::vector<server_query> removed_queries{};
 
-			get_server_queries().access([&](std::vector<server_query>& server_queries)
+			get_server_queries().access([&](query_engine& engine)
 			{
-				size_t sent_queries = 0;
+				const auto now = query_clock::now();
 
-				const auto now = std::chrono::high_resolution_clock::now();
-				for (auto i = server_queries.begin(); i != server_queries.end();)
+				while (!engine.timeouts.empty() && engine.timeouts.front().deadline <= now)
 				{
-					if (!i->sent)
+					// Answered queries are no longer in flight, their timeout entry is simply dropped
+					const auto entry = engine.in_flight.find(engine.timeouts.front().key);
+					if (entry != engine.in_flight.end())
 					{
-						if (++sent_queries < 40)
-						{
-							send_server_query(*i);
-						}
+						removed_queries.emplace_back(std::move(entry->second));
+						engine.in_flight.erase(entry);
 
-						++i;
-						continue;
+						++engine.stats.timed_out;
+						++engine.stats.window_timed_out;
 					}
 
-					if ((now - i->query_time) < 1s)
-					{
-						++i;
-						continue;
-					}
-
-					removed_queries.emplace_back(std::move(*i));
-					i = server_queries.erase(i);
+					engine.timeouts.pop_front();
 				}
+
+				adjust_query_rate(engine, now);
+				send_pending_queries(engine, now);
 			});
 
 			const utils::info_string empty{};
@@ -311,18 +433,38 @@ namespace party
 				query.callback(false, query.host, empty, 0);
 			}
 		}
+
+		void print_query_stats()
+		{
+			get_server_queries().access([](const query_engine& engine)
+			{
+				const auto& stats = engine.stats;
+				const auto completed = stats.responded + stats.timed_out;
+
+				printf("Server queries: %llu sent, %llu responded, %llu timed out (%.1f%% loss)\n", stats.sent,
+				       stats.responded, stats.timed_out,
+				       completed ? 100.0 * static_cast<double>(stats.timed_out) / static_cast<double>(completed) : 0.0);
+				printf("Send rate: %.0f queries/s, %zu pending, %zu in flight\n", engine.rate, engine.pending.size(),
+				       engine.in_flight.size());
+				printf("RTT: avg %.1fms | <=25ms %llu | <=50ms %llu | <=100ms %llu | <=200ms %llu | <=400ms %llu | >400ms %llu\n",
+				       stats.responded
+					       ? static_cast<double>(stats.rtt_total.count()) / static_cast<double>(stats.responded)
+					       : 0.0,
+				       stats.rtt_buckets[0], stats.rtt_buckets[1], stats.rtt_buckets[2], stats.rtt_buckets[3],
+				       stats.rtt_buckets[4], stats.rtt_buckets[5]);
+			});
+		}
 	}
 
 	void query_server(const game::netadr_t& host, query_callback callback)
 	{
 		server_query query{};
-		query.sent = false;
 		query.host = host;
 		query.callback = std::move(callback);
 
-		get_server_queries().access([&](std::vector<server_query>& server_queries)
+		get_server_queries().access([&](query_engine& engine)
 		{
-			server_queries.emplace_back(std::move(query));
+			engine.pending.emplace_back(std::move(query));
 		});
 	}
 
@@ -345,14 +487,18 @@ namespace party
 			utils::hook::jump(0x141EE5FE0_g, &connect_stub);
 
 			network::on("infoResponse", handle_info_response);
-			scheduler::loop(cleanup_queried_servers, scheduler::async, 100ms);
+			scheduler::loop(cleanup_queried_servers, scheduler::async, 20ms);
+
+			command::add("server_query_stats", print_query_stats);
 		}
 
 		void pre_destroy() override
 		{
-			get_server_queries().access([](std::vector<server_query>& s)
+			get_server_queries().access([](query_engine& engine)
 			{
-				s = {};
+				engine.pending = {};
+				engine.in_flight = {};
+				engine.timeouts = {};
 			});
 		}
 	};
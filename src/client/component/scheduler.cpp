@@ -2,6 +2,7 @@
 #include "loader/component_loader.hpp"
 
 #include "scheduler.hpp"
+#include "command.hpp"
 
 #include "game/game.hpp"
 
@@ -13,72 +14,236 @@ namespace scheduler
 {
 	namespace
 	{
+		using clock = std::chrono::high_resolution_clock;
+
+		// Executions of a pipeline taking longer than this are counted as overruns
+		constexpr auto frame_budget = 1ms;
+
+		struct task_stats
+		{
+			std::string function{};
+			uint64_t calls{0};
+			clock::duration total{};
+			clock::duration max{};
+		};
+
 		struct task
 		{
 			std::function<bool()> handler{};
 			std::chrono::milliseconds interval{};
-			std::chrono::high_resolution_clock::time_point last_call{};
+			clock::time_point next_call{};
+			std::source_location location{};
+			task_stats* stats{};
+			uint64_t sequence{};
+			clock::duration duration{};
 		};
 
-		using task_list = std::vector<task>;
+		// Multi-producer, single-consumer queue of submitted tasks.
+		// Producers push onto a lock-free stack, the consumer takes the whole stack at once.
+		class task_queue
+		{
+		public:
+			task_queue() = default;
+
+			task_queue(task_queue&&) = delete;
+			task_queue(const task_queue&) = delete;
+			task_queue& operator=(task_queue&&) = delete;
+			task_queue& operator=(const task_queue&) = delete;
+
+			~task_queue()
+			{
+				this->consume([](task&&)
+				{
+				});
+			}
+
+			void push(task&& task)
+			{
+				auto* entry = new node{std::move(task)};
+				entry->next = this->head_.load(std::memory_order_relaxed);
+
+				while (!this->head_.compare_exchange_weak(entry->next, entry, std::memory_order_release,
+				                                          std::memory_order_relaxed))
+				{
+				}
+			}
+
+			template <typename F>
+			void consume(F&& callback)
+			{
+				auto* entry = this->head_.exchange(nullptr, std::memory_order_acquire);
+
+				// The stack holds the newest task first, restore submission order
+				node* ordered = nullptr;
+				while (entry)
+				{
+					auto* next = entry->next;
+					entry->next = ordered;
+					ordered = entry;
+					entry = next;
+				}
+
+				while (ordered)
+				{
+					std::unique_ptr<node> current{ordered};
+					ordered = ordered->next;
+
+					callback(std::move(current->value));
+				}
+			}
+
+		private:
+			struct node
+			{
+				task value{};
+				node* next{};
+			};
+
+			std::atomic<node*> head_{nullptr};
+		};
+
+		using task_stats_map = std::map<std::pair<const char*, uint32_t>, task_stats>;
+
+		struct pipeline_stats
+		{
+			task_stats_map tasks{};
+			uint64_t frames{0};
+			uint64_t overruns{0};
+			clock::duration max_frame{};
+			size_t active_tasks{0};
+		};
 
 		class task_pipeline
 		{
 		public:
 			void add(task&& task)
 			{
-				new_callbacks_.access([&task](task_list& tasks)
-				{
-					tasks.emplace_back(std::move(task));
-				});
+				this->new_callbacks_.push(std::move(task));
 			}
 
 			void execute()
 			{
-				callbacks_.access([&](task_list& tasks)
+				const auto start = clock::now();
+				std::vector<task> due_tasks{};
+
 				{
+					std::lock_guard<std::mutex> _(this->mutex_);
 					this->merge_callbacks();
 
-					for (auto i = tasks.begin(); i != tasks.end();)
+					while (!this->tasks_.empty() && this->tasks_.front().next_call <= start)
 					{
-						const auto now = std::chrono::high_resolution_clock::now();
-						const auto diff = now - i->last_call;
+						std::ranges::pop_heap(this->tasks_, is_later);
+						due_tasks.emplace_back(std::move(this->tasks_.back()));
+						this->tasks_.pop_back();
+					}
+				}
 
-						if (diff < i->interval)
-						{
-							++i;
-							continue;
-						}
+				// Tasks run without any lock held, so they are free to schedule new tasks
+				for (auto& task : due_tasks)
+				{
+					const auto task_start = clock::now();
+					const auto res = task.handler();
+					const auto task_end = clock::now();
 
-						i->last_call = now;
+					task.duration = task_end - task_start;
 
-						const auto res = i->handler();
-						if (res == cond_end)
-						{
-							i = tasks.erase(i);
-						}
-						else
-						{
-							++i;
-						}
+					if (res == cond_end)
+					{
+						task.handler = {};
+					}
+					else
+					{
+						task.next_call = task_start + task.interval;
+					}
+				}
+
+				const auto frame_time = clock::now() - start;
+
+				this->stats_.access([&](pipeline_stats& stats)
+				{
+					++stats.frames;
+					stats.max_frame = std::max(stats.max_frame, frame_time);
+
+					if (frame_time > frame_budget)
+					{
+						++stats.overruns;
+					}
+
+					for (const auto& task : due_tasks)
+					{
+						++task.stats->calls;
+						task.stats->total += task.duration;
+						task.stats->max = std::max(task.stats->max, task.duration);
 					}
 				});
+
+				if (due_tasks.empty())
+				{
+					return;
+				}
+
+				std::lock_guard<std::mutex> _(this->mutex_);
+
+				for (auto& task : due_tasks)
+				{
+					if (task.handler)
+					{
+						this->tasks_.emplace_back(std::move(task));
+						std::ranges::push_heap(this->tasks_, is_later);
+					}
+				}
+
+				this->stats_.access([&](pipeline_stats& stats)
+				{
+					stats.active_tasks = this->tasks_.size();
+				});
+			}
+
+			pipeline_stats get_stats() const
+			{
+				return this->stats_.copy();
 			}
 
 		private:
-			utils::concurrency::container<task_list> new_callbacks_;
-			utils::concurrency::container<task_list, std::recursive_mutex> callbacks_;
+			task_queue new_callbacks_;
+			std::mutex mutex_;
+
+			// Min-heap ordered by the time a task is due next
+			std::vector<task> tasks_;
+			uint64_t sequence_{0};
+
+			utils::concurrency::container<pipeline_stats> stats_;
+
+			static bool is_later(const task& a, const task& b)
+			{
+				if (a.next_call != b.next_call)
+				{
+					return a.next_call > b.next_call;
+				}
+
+				return a.sequence > b.sequence;
+			}
 
 			void merge_callbacks()
 			{
-				callbacks_.access([&](task_list& tasks)
+				this->new_callbacks_.consume([&](task&& task)
 				{
-					new_callbacks_.access([&](task_list& new_tasks)
+					task.sequence = this->sequence_++;
+
+					this->stats_.access([&](pipeline_stats& stats)
 					{
-						tasks.insert(tasks.end(), std::move_iterator(new_tasks.begin()),
-						             std::move_iterator(new_tasks.end()));
-						new_tasks = {};
+						const auto key = std::make_pair(task.location.file_name(), task.location.line());
+						auto& entry = stats.tasks[key];
+						if (entry.function.empty())
+						{
+							entry.function = task.location.function_name();
+						}
+
+						task.stats = &entry;
 					});
+
+					this->tasks_.emplace_back(std::move(task));
+					std::ranges::push_heap(this->tasks_, is_later);
 				});
 			}
 		};
@@ -108,6 +273,81 @@ namespace scheduler
 			main_frame_hook.invoke<void>();
 			execute(main);
 		}
+
+		const char* get_pipeline_name(const pipeline type)
+		{
+			switch (type)
+			{
+			case async:
+				return "async";
+			case renderer:
+				return "renderer";
+			case server:
+				return "server";
+			case main:
+				return "main";
+			case dvars_flags_patched:
+				return "dvars_flags_patched";
+			case dvars_loaded:
+				return "dvars_loaded";
+			default:
+				return "unknown";
+			}
+		}
+
+		const char* get_file_name(const char* path)
+		{
+			const auto* name = path;
+			for (const auto* c = path; *c; ++c)
+			{
+				if (*c == '/' || *c == '\\')
+				{
+					name = c + 1;
+				}
+			}
+
+			return name;
+		}
+
+		double to_us(const clock::duration duration)
+		{
+			return std::chrono::duration<double, std::micro>(duration).count();
+		}
+
+		void print_stats()
+		{
+			for (auto i = 0; i < count; ++i)
+			{
+				const auto type = static_cast<pipeline>(i);
+				const auto stats = pipelines[type].get_stats();
+
+				printf("[ Scheduler ] %s: %zu tasks, %llu frames, %llu overruns (> %lldms), max frame %.1fus\n",
+				       get_pipeline_name(type), stats.active_tasks, stats.frames, stats.overruns,
+				       frame_budget.count(), to_us(stats.max_frame));
+
+				std::vector<const task_stats_map::value_type*> tasks{};
+				for (const auto& entry : stats.tasks)
+				{
+					if (entry.second.calls)
+					{
+						tasks.emplace_back(&entry);
+					}
+				}
+
+				std::ranges::sort(tasks, [](const auto* a, const auto* b)
+				{
+					return a->second.total > b->second.total;
+				});
+
+				for (const auto* entry : tasks)
+				{
+					const auto& [location, task] = *entry;
+					printf("    %10llu calls, avg %9.1fus, max %9.1fus  %s:%u (%s)\n", task.calls,
+					       to_us(task.total) / static_cast<double>(task.calls), to_us(task.max),
+					       get_file_name(location.first), location.second, task.function.data());
+				}
+			}
+		}
 	}
 
 	void execute(const pipeline type)
@@ -117,36 +357,37 @@ namespace scheduler
 	}
 
 	void schedule(const std::function<bool()>& callback, const pipeline type,
-	              const std::chrono::milliseconds delay)
+	              const std::chrono::milliseconds delay, const std::source_location& location)
 	{
 		assert(type >= 0 && type < pipeline::count);
 
 		task task;
 		task.handler = callback;
 		task.interval = delay;
-		task.last_call = std::chrono::high_resolution_clock::now();
+		task.next_call = clock::now() + delay;
+		task.location = location;
 
 		pipelines[type].add(std::move(task));
 	}
 
 	void loop(const std::function<void()>& callback, const pipeline type,
-	          const std::chrono::milliseconds delay)
+	          const std::chrono::milliseconds delay, const std::source_location& location)
 	{
 		schedule([callback]()
 		{
 			callback();
 			return cond_continue;
-		}, type, delay);
+		}, type, delay, location);
 	}
 
 	void once(const std::function<void()>& callback, const pipeline type,
-	          const std::chrono::milliseconds delay)
+	          const std::chrono::milliseconds delay, const std::source_location& location)
 	{
 		schedule([callback]()
 		{
 			callback();
 			return cond_end;
-		}, type, delay);
+		}, type, delay, location);
 	}
 
 	struct component final : generic_component
@@ -175,6 +416,8 @@ namespace scheduler
 			main_frame_hook.create(game::select(0x1420F8E00, 0x1405020E0), main_frame_stub);
 
 			utils::hook::call(game::select(0x14225522E, 0x140538427), g_clear_vehicle_inputs_stub);
+
+			command::add("scheduler_stats", print_stats);
 		}
 
 		void pre_destroy() override
@@ -31,11 +31,14 @@ namespace scheduler
 	void execute(pipeline type);
 
 	void schedule(const std::function<bool()>& callback, pipeline type,
-	              std::chrono::milliseconds delay = 0ms);
+	              std::chrono::milliseconds delay = 0ms,
+	              const std::source_location& location = std::source_location::current());
 	void loop(const std::function<void()>& callback, pipeline type,
-	          std::chrono::milliseconds delay = 0ms);
+	          std::chrono::milliseconds delay = 0ms,
+	          const std::source_location& location = std::source_location::current());
 	void once(const std::function<void()>& callback, pipeline type,
-	          std::chrono::milliseconds delay = 0ms);
+	          std::chrono::milliseconds delay = 0ms,
+	          const std::source_location& location = std::source_location::current());
 	void on_game_initialized(const std::function<void()>& callback, pipeline type,
 	                         std::chrono::milliseconds delay = 0ms);
 }
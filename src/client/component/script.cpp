@@ -4,6 +4,7 @@
 #include "game/utils.hpp"
 
 #include "game_event.hpp"
+#include "command.hpp"
 
 #include <utils/hook.hpp>
 #include <utils/string.hpp>
@@ -18,7 +19,8 @@ namespace script
 		utils::hook::detour db_find_x_asset_header_hook;
 		utils::hook::detour gscr_get_bgb_remaining_hook;
 
-		utils::memory::allocator allocator;
+		// Scripts live until the game ends, so they are bump-allocated and released together
+		utils::memory::allocator allocator{0x100000};
 		std::unordered_map<std::string, game::RawFile*> loaded_scripts;
 
 		game::RawFile* get_loaded_script(const std::string& name)
@@ -187,6 +189,19 @@ namespace script
 			allocator.clear();
 		}
 
+		void print_allocator_stats(const char* name, const utils::memory::allocator& mem_allocator)
+		{
+			const auto stats = mem_allocator.get_stats();
+			printf("%s: %zu bytes live (peak %zu), %zu allocations live, %zu total\n", name, stats.live_bytes,
+			       stats.peak_bytes, stats.live_allocations, stats.total_allocations);
+		}
+
+		void print_memory_stats()
+		{
+			print_allocator_stats("Global allocator", *utils::memory::get_allocator());
+			print_allocator_stats("Script allocator", allocator);
+		}
+
 		void begin_load_scripts_stub(game::scriptInstance_t inst, int user)
 		{
 			game::Scr_BeginLoadScripts(inst, user);
@@ -228,6 +243,8 @@ namespace script
 			// Workaround for "Out of X" gobblegum
 			gscr_get_bgb_remaining_hook.create(game::select(0x141A8CAB0, 0x1402D2310),
 			                                   scr_loot_get_item_quantity_stub);
+
+			command::add("memory_stats", print_memory_stats);
 		}
 	};
 };
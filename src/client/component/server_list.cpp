@@ -24,15 +24,16 @@ namespace server_list
 		{
 			game::netadr_t address{};
 			bool responded{false};
-			std::unordered_set<game::netadr_t> results{};
 		};
 
 		struct state
 		{
 			std::vector<master_query> masters{};
+			std::unordered_set<game::netadr_t> results{};
 			bool requesting{false};
 			std::chrono::high_resolution_clock::time_point query_start{};
-			callback callback{};
+			servers_callback servers_callback{};
+			complete_callback complete_callback{};
 		};
 
 		utils::concurrency::container<state> master_state;
@@ -40,6 +41,24 @@ namespace server_list
 		utils::concurrency::container<server_list> favorite_servers{};
 		utils::concurrency::container<std::vector<game::netadr_t>> recent_servers{};
 
+		// Entries not refreshed within this period are dropped when the cache is loaded
+		constexpr auto server_cache_lifetime = 7 * 24h;
+
+		struct server_cache_entry
+		{
+			utils::info_string info{};
+			uint32_t ping{};
+			int64_t timestamp{};
+		};
+
+		struct server_cache
+		{
+			std::unordered_map<game::netadr_t, server_cache_entry> entries{};
+			bool dirty{false};
+		};
+
+		utils::concurrency::container<server_cache> server_info_cache{};
+
 		std::unordered_set<game::netadr_t> parse_server_list_data(const network::data_view& data)
 		{
 			std::unordered_set<game::netadr_t> result{};
@@ -94,25 +113,14 @@ namespace server_list
 		void finalize_master_query(state& s)
 		{
 			s.requesting = false;
-			auto cb = std::move(s.callback);
-
-			std::unordered_set<game::netadr_t> merged{};
-			bool any_success = false;
-
-			for (const auto& m : s.masters)
-			{
-				if (!m.results.empty())
-				{
-					any_success = true;
-				}
-				for (const auto& addr : m.results)
-				{
-					merged.insert(addr);
-				}
-			}
+			auto cb = std::move(s.complete_callback);
+			const auto any_success = !s.results.empty();
 
 			s.masters.clear();
-			cb(any_success, merged);
+			s.results.clear();
+			s.servers_callback = {};
+
+			cb(any_success);
 		}
 
 		void handle_server_list_response(const game::netadr_t& target,
@@ -139,7 +147,22 @@ namespace server_list
 			}
 
 			matched->responded = true;
-			matched->results = parse_server_list_data(data);
+
+			// Hand out servers as soon as a master reports them, so they can be queried
+			// while other masters are still responding
+			std::vector<game::netadr_t> new_servers{};
+			for (const auto& address : parse_server_list_data(data))
+			{
+				if (s.results.emplace(address).second)
+				{
+					new_servers.emplace_back(address);
+				}
+			}
+
+			if (!new_servers.empty())
+			{
+				s.servers_callback(new_servers);
+			}
 
 			if (all_masters_done(s))
 			{
@@ -262,6 +285,100 @@ namespace server_list
 			});
 		}
 
+		std::string get_server_cache_file_path()
+		{
+			return "boiii_players/user/server_cache.txt";
+		}
+
+		int64_t get_current_time()
+		{
+			return std::chrono::duration_cast<std::chrono::seconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+
+		void write_server_cache()
+		{
+			std::string buffer{};
+
+			const auto dirty = server_info_cache.access<bool>([&buffer](server_cache& cache)
+			{
+				if (!cache.dirty)
+				{
+					return false;
+				}
+
+				for (const auto& [address, entry] : cache.entries)
+				{
+					const auto info = entry.info.build();
+					if (info.find('\n') != std::string::npos)
+					{
+						continue;
+					}
+
+					buffer.append(utils::string::va("%i.%i.%i.%i:%hu %lld %u %s\n", address.ipv4.a, address.ipv4.b,
+					                                address.ipv4.c, address.ipv4.d, address.port, entry.timestamp,
+					                                entry.ping, info.data()));
+				}
+
+				cache.dirty = false;
+				return true;
+			});
+
+			if (dirty)
+			{
+				utils::io::write_file(get_server_cache_file_path(), buffer);
+			}
+		}
+
+		void read_server_cache()
+		{
+			std::string data;
+			if (!utils::io::read_file(get_server_cache_file_path(), &data))
+			{
+				return;
+			}
+
+			const auto min_timestamp = get_current_time() - std::chrono::duration_cast<std::chrono::seconds>(
+				server_cache_lifetime).count();
+
+			server_info_cache.access([&](server_cache& cache)
+			{
+				cache.entries.clear();
+
+				for (const auto& line : utils::string::split(data, '\n'))
+				{
+					// <address> <timestamp> <ping> <info string>
+					const auto address_end = line.find(' ');
+					const auto timestamp_end = line.find(' ', address_end + 1);
+					const auto ping_end = line.find(' ', timestamp_end + 1);
+					if (address_end == std::string::npos || timestamp_end == std::string::npos || ping_end ==
+						std::string::npos)
+					{
+						continue;
+					}
+
+					const auto address = network::address_from_string(line.substr(0, address_end));
+					if (address.type == game::NA_BAD)
+					{
+						continue;
+					}
+
+					server_cache_entry entry{};
+					entry.timestamp = std::strtoll(line.data() + address_end + 1, nullptr, 10);
+					entry.ping = static_cast<uint32_t>(std::strtoul(line.data() + timestamp_end + 1, nullptr, 10));
+					entry.info = utils::info_string{std::string_view{line}.substr(ping_end + 1)};
+					entry.info.remove("challenge");
+
+					if (entry.timestamp < min_timestamp)
+					{
+						continue;
+					}
+
+					cache.entries[address] = std::move(entry);
+				}
+			});
+		}
+
 		std::string get_lan_servers_file_path()
 		{
 			return "boiii_players/user/lan_servers.txt";
@@ -350,9 +467,9 @@ namespace server_list
 		return servers;
 	}
 
-	void request_servers(callback callback)
+	void request_servers(servers_callback servers_callback, complete_callback complete_callback)
 	{
-		master_state.access([&callback](state& s)
+		master_state.access([&](state& s)
 		{
 			auto masters = get_master_servers();
 			if (masters.empty())
@@ -362,7 +479,9 @@ namespace server_list
 
 			s.requesting = true;
 			s.masters.clear();
-			s.callback = std::move(callback);
+			s.results.clear();
+			s.servers_callback = std::move(servers_callback);
+			s.complete_callback = std::move(complete_callback);
 			s.query_start = std::chrono::high_resolution_clock::now();
 
 			for (const auto& addr : masters)
@@ -451,6 +570,53 @@ namespace server_list
 		return recent_servers;
 	}
 
+	void cache_server_info(const game::netadr_t& addr, const utils::info_string& info, const uint32_t ping)
+	{
+		server_info_cache.access([&](server_cache& cache)
+		{
+			auto& entry = cache.entries[addr];
+			entry.info = info;
+
+			// The challenge is unique to the query it answered and must not be served later
+			entry.info.remove("challenge");
+			entry.ping = ping;
+			entry.timestamp = get_current_time();
+
+			cache.dirty = true;
+		});
+	}
+
+	std::optional<cached_server> get_cached_server(const game::netadr_t& addr)
+	{
+		using result_type = std::optional<cached_server>;
+		return server_info_cache.access<result_type>([&](const server_cache& cache) -> result_type
+		{
+			const auto entry = cache.entries.find(addr);
+			if (entry == cache.entries.end())
+			{
+				return {};
+			}
+
+			return cached_server{entry->first, entry->second.info, entry->second.ping};
+		});
+	}
+
+	std::vector<cached_server> get_cached_servers()
+	{
+		return server_info_cache.access<std::vector<cached_server>>([](const server_cache& cache)
+		{
+			std::vector<cached_server> result{};
+			result.reserve(cache.entries.size());
+
+			for (const auto& [address, entry] : cache.entries)
+			{
+				result.emplace_back(cached_server{address, entry.info, entry.ping});
+			}
+
+			return result;
+		});
+	}
+
 	struct component final : client_component
 	{
 		void post_unpack() override
@@ -494,8 +660,11 @@ namespace server_list
 			{
 				read_favorite_servers();
 				read_recent_servers();
+				read_server_cache();
 			}, scheduler::main);
 
+			scheduler::loop(write_server_cache, scheduler::async, 30s);
+
 			command::add("lan_add", [](const command::params& params)
 			{
 				if (params.size() < 2)
@@ -509,11 +678,15 @@ namespace server_list
 
 		void pre_destroy() override
 		{
+			write_server_cache();
+
 			master_state.access([](state& s)
 			{
 				s.requesting = false;
 				s.masters.clear();
-				s.callback = {};
+				s.results.clear();
+				s.servers_callback = {};
+				s.complete_callback = {};
 			});
 		}
 	};
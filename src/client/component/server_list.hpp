@@ -2,13 +2,15 @@
 #include <game/game.hpp>
 
 #include <utils/concurrency.hpp>
+#include <utils/info_string.hpp>
 
 namespace server_list
 {
 	std::vector<game::netadr_t> get_master_servers();
 
-	using callback = std::function<void(bool, const std::unordered_set<game::netadr_t>&)>;
-	void request_servers(callback callback);
+	using servers_callback = std::function<void(const std::vector<game::netadr_t>&)>;
+	using complete_callback = std::function<void(bool)>;
+	void request_servers(servers_callback servers_callback, complete_callback complete_callback);
 
 	void add_favorite_server(game::netadr_t addr);
 	void remove_favorite_server(game::netadr_t addr);
@@ -19,4 +21,15 @@ namespace server_list
 	void remove_recent_server(game::netadr_t addr);
 	using recent_list = std::vector<game::netadr_t>;
 	utils::concurrency::container<recent_list>& get_recent_servers();
+
+	struct cached_server
+	{
+		game::netadr_t address{};
+		utils::info_string info{};
+		uint32_t ping{};
+	};
+
+	void cache_server_info(const game::netadr_t& addr, const utils::info_string& info, uint32_t ping);
+	std::optional<cached_server> get_cached_server(const game::netadr_t& addr);
+	std::vector<cached_server> get_cached_servers();
 }
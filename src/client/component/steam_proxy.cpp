@@ -29,12 +29,27 @@ namespace steam_proxy
 		steam::interface client_user{};
 		steam::interface client_utils{};
 		steam::interface client_friends{};
-		steam::interface client_ugc{};
+
+		// Used by background refreshes, cleanups on the main thread wait for them
+		utils::concurrency::container<steam::interface> client_ugc{};
 
 		steam::client* steam_client{};
-		steam::ugc* steam_ugc{};
+		std::atomic<steam::ugc*> steam_ugc{};
+
+		// Steam is only asked again once the snapshot is older than this
+		constexpr auto subscribed_items_ttl = 5s;
+
+		struct subscribed_item_cache
+		{
+			// Snapshot readers see, it is only replaced by update_subscribed_items
+			std::shared_ptr<const subscribed_item_map> items{};
+			// Most recent refresh, waiting to replace the one readers see
+			std::shared_ptr<const subscribed_item_map> latest{};
+			std::chrono::steady_clock::time_point last_update{};
+		};
 
-		utils::concurrency::container<subscribed_item_map> subscribed_items;
+		utils::concurrency::container<subscribed_item_cache> subscribed_items;
+		std::atomic_bool refreshing_items{false};
 
 		enum class ownership_state
 		{
@@ -88,7 +103,10 @@ namespace steam_proxy
 			client_user = client_engine.invoke<void*>(8, global_user, steam_pipe);
 			client_utils = client_engine.invoke<void*>(14, steam_pipe);
 			client_friends = client_engine.invoke<void*>(13, global_user, steam_pipe);
-			client_ugc = client_engine.invoke<void*>(62, global_user, steam_pipe);
+			client_ugc.access([](steam::interface& ugc)
+			{
+				ugc = client_engine.invoke<void*>(62, global_user, steam_pipe);
+			});
 		}
 
 		void do_cleanup()
@@ -97,7 +115,11 @@ namespace steam_proxy
 			client_user = nullptr;
 			client_utils = nullptr;
 			client_friends = nullptr;
-			client_ugc = nullptr;
+
+			client_ugc.access([](steam::interface& ugc)
+			{
+				ugc = nullptr;
+			});
 
 			steam_pipe = 0;
 			global_user = 0;
@@ -292,10 +314,36 @@ namespace steam_proxy
 		steam_ugc = static_cast<steam::ugc*>(ugc);
 	}
 
-	void update_map_client(subscribed_item_map& map)
+	std::shared_ptr<const subscribed_item_map> get_subscribed_items()
+	{
+		return subscribed_items.access<std::shared_ptr<const subscribed_item_map>>(
+			[](const subscribed_item_cache& cache)
+			{
+				return cache.items;
+			});
+	}
+
+	// Installed items that kept their state are taken over without asking for their install info again
+	bool reuse_item(const subscribed_item_map& previous, const uint64_t id, const uint32_t state,
+	                subscribed_item_map& map)
+	{
+		// k_EItemStateNeedsUpdate | k_EItemStateDownloading | k_EItemStateDownloadPending
+		constexpr uint32_t pending_states = 8 | 16 | 32;
+
+		const auto entry = previous.find(id);
+		if (entry == previous.end() || entry->second.state != state || (state & pending_states))
+		{
+			return false;
+		}
+
+		map[id] = entry->second;
+		return true;
+	}
+
+	void update_map_client(steam::interface& ugc, subscribed_item_map& map, const subscribed_item_map& previous)
 	{
 		const auto app_id = steam::SteamUtils()->GetAppID();
-		const auto num_items = client_ugc.invoke<uint32_t>("GetNumSubscribedItems", app_id);
+		const auto num_items = ugc.invoke<uint32_t>("GetNumSubscribedItems", app_id);
 
 		if (!num_items)
 		{
@@ -305,29 +353,32 @@ namespace steam_proxy
 		std::vector<uint64_t> ids;
 		ids.resize(num_items);
 
-		auto result = client_ugc.invoke<uint32_t>("GetSubscribedItems", app_id, ids.data(),
-		                                          num_items);
+		auto result = ugc.invoke<uint32_t>("GetSubscribedItems", app_id, ids.data(), num_items);
 		result = std::min(num_items, result);
 
 		for (uint32_t i = 0; i < result; ++i)
 		{
+			const auto state = ugc.invoke<uint32_t>("GetItemState", app_id, ids[i]);
+			if (reuse_item(previous, ids[i], state, map))
+			{
+				continue;
+			}
+
 			char buffer[0x1000] = {0};
 			subscribed_item item{};
 
-			item.state = client_ugc.invoke<uint32_t>("GetItemState", app_id, ids[i]);
-			item.available = client_ugc.invoke<bool>("GetItemInstallInfo", app_id, ids[i],
-			                                         &item.size_on_disk,
-			                                         buffer,
-			                                         sizeof(buffer), &item.time_stamp);
+			item.state = state;
+			item.available = ugc.invoke<bool>("GetItemInstallInfo", app_id, ids[i], &item.size_on_disk, buffer,
+			                                  sizeof(buffer), &item.time_stamp);
 			item.path = buffer;
 
 			map[ids[i]] = std::move(item);
 		}
 	}
 
-	void update_map_steam(subscribed_item_map& map)
+	void update_map_steam(steam::ugc* ugc, subscribed_item_map& map, const subscribed_item_map& previous)
 	{
-		const auto num_items = steam_ugc->GetNumSubscribedItems();
+		const auto num_items = ugc->GetNumSubscribedItems();
 
 		if (!num_items)
 		{
@@ -337,56 +388,139 @@ namespace steam_proxy
 		std::vector<uint64_t> ids;
 		ids.resize(num_items);
 
-		auto result = steam_ugc->GetSubscribedItems(ids.data(), num_items);
+		auto result = ugc->GetSubscribedItems(ids.data(), num_items);
 		result = std::min(num_items, result);
 
 		for (uint32_t i = 0; i < result; ++i)
 		{
+			const auto state = ugc->GetItemState(ids[i]);
+			if (reuse_item(previous, ids[i], state, map))
+			{
+				continue;
+			}
+
 			char buffer[0x1000] = {0};
 			subscribed_item item{};
 
-			item.state = steam_ugc->GetItemState(ids[i]);
-			item.available = steam_ugc->GetItemInstallInfo(ids[i], &item.size_on_disk, buffer, sizeof(buffer),
-			                                               &item.time_stamp);
+			item.state = state;
+			item.available = ugc->GetItemInstallInfo(ids[i], &item.size_on_disk, buffer, sizeof(buffer),
+			                                         &item.time_stamp);
 			item.path = buffer;
 
 			map[ids[i]] = std::move(item);
 		}
 	}
 
-	void update_subscribed_items()
+	void refresh_subscribed_items()
 	{
-		subscribed_item_map map{};
+		static const subscribed_item_map empty_map{};
+
+		const auto previous = subscribed_items.access<std::shared_ptr<const subscribed_item_map>>(
+			[](const subscribed_item_cache& cache)
+			{
+				return cache.latest;
+			});
+
+		auto map = std::make_shared<subscribed_item_map>();
 
 		const auto _ = utils::finally([&]
 		{
-			subscribed_items.access([&](subscribed_item_map& items)
+			subscribed_items.access([&](subscribed_item_cache& cache)
 			{
-				items = std::move(map);
+				cache.latest = std::move(map);
+				cache.last_update = std::chrono::steady_clock::now();
+
+				if (!cache.items)
+				{
+					cache.items = cache.latest;
+				}
 			});
 		});
 
-		try
+		const auto used_client = client_ugc.access<bool>([&](steam::interface& ugc)
 		{
-			if (client_ugc)
+			if (!ugc)
 			{
-				update_map_client(map);
+				return false;
 			}
-			else if (steam_ugc)
+
+			try
 			{
-				update_map_steam(map);
+				update_map_client(ugc, *map, previous ? *previous : empty_map);
 			}
+			catch (...)
+			{
+				ugc = {};
+			}
+
+			return true;
+		});
+
+		auto* ugc = steam_ugc.load();
+		if (used_client || !ugc)
+		{
+			return;
+		}
+
+		try
+		{
+			update_map_steam(ugc, *map, previous ? *previous : empty_map);
 		}
 		catch (...)
 		{
-			client_ugc = {};
+			// Keep whatever was collected, the next refresh asks again
 		}
 	}
 
+	// The game starts enumerating subscribed items with GetNumSubscribedItems, which calls this.
+	// Finished refreshes only become visible here, so the count, the list and the item states
+	// of one enumeration come from the same snapshot.
+	void update_subscribed_items()
+	{
+		const auto [has_items, expired] = subscribed_items.access<std::pair<bool, bool>>(
+			[](subscribed_item_cache& cache)
+			{
+				cache.items = cache.latest;
+				return std::make_pair(static_cast<bool>(cache.items),
+				                      std::chrono::steady_clock::now() - cache.last_update >= subscribed_items_ttl);
+			});
+
+		if ((has_items && !expired) || refreshing_items.exchange(true))
+		{
+			return;
+		}
+
+		// The first snapshot is built right away, later ones are refreshed in the background
+		if (!has_items)
+		{
+			const auto _ = utils::finally([]
+			{
+				refreshing_items = false;
+			});
+
+			refresh_subscribed_items();
+			return;
+		}
+
+		scheduler::once([]
+		{
+			const auto _ = utils::finally([]
+			{
+				refreshing_items = false;
+			});
+
+			refresh_subscribed_items();
+		}, scheduler::async);
+	}
+
 	void access_subscribed_items(
 		const std::function<void(const subscribed_item_map&)>& callback)
 	{
-		subscribed_items.access(callback);
+		static const subscribed_item_map empty_map{};
+
+		// Readers work on the snapshot published by update_subscribed_items
+		const auto items = get_subscribed_items();
+		callback(items ? *items : empty_map);
 	}
 }
 
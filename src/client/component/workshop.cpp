@@ -10,7 +10,9 @@
 #include <utils/string.hpp>
 #include <utils/io.hpp>
 #include <utils/thread.hpp>
+#include <utils/concurrency.hpp>
 #include "steamcmd.hpp"
+#include "workshop_scanner.hpp"
 
 #include <condition_variable>
 #include <mutex>
@@ -50,6 +52,100 @@ namespace workshop
 		std::atomic<bool> dlc_thread_shutdown{false};
 		std::thread dlc_popup_thread_obj;
 
+		struct content_index
+		{
+			std::unordered_map<std::string, unsigned int> usermaps{}; // folderName -> usermapsPool slot
+			std::unordered_map<std::string, unsigned int> mods{}; // publisherId -> modsPool slot
+		};
+
+		utils::concurrency::container<content_index> workshop_index;
+
+		template <typename F>
+		std::unordered_map<std::string, unsigned int> build_index(const game::workshop_data* pool,
+		                                                          const unsigned int count, F&& get_key)
+		{
+			std::unordered_map<std::string, unsigned int> index{};
+			index.reserve(count);
+
+			for (unsigned int i = 0; i < count; ++i)
+			{
+				// First entry wins, just like the linear lookups did
+				index.try_emplace(get_key(pool[i]), i);
+			}
+
+			return index;
+		}
+
+		void index_usermaps()
+		{
+			auto usermaps = build_index(game::usermapsPool, *game::usermapsCount, [](const game::workshop_data& data)
+			{
+				return std::string(data.folderName);
+			});
+
+			workshop_index.access([&](content_index& index)
+			{
+				index.usermaps = std::move(usermaps);
+			});
+		}
+
+		void index_mods()
+		{
+			auto mods = build_index(game::modsPool, *game::modsCount, [](const game::workshop_data& data)
+			{
+				return std::string(data.publisherId);
+			});
+
+			workshop_index.access([&](content_index& index)
+			{
+				index.mods = std::move(mods);
+			});
+		}
+
+		const game::workshop_data* find_usermap(const std::string& folder_name)
+		{
+			const auto slot = workshop_index.access<std::optional<unsigned int>>([&](const content_index& index)
+				-> std::optional<unsigned int>
+				{
+					const auto entry = index.usermaps.find(folder_name);
+					if (entry == index.usermaps.end())
+					{
+						return {};
+					}
+
+					return entry->second;
+				});
+
+			if (!slot || *slot >= *game::usermapsCount || game::usermapsPool[*slot].folderName != folder_name)
+			{
+				return nullptr;
+			}
+
+			return &game::usermapsPool[*slot];
+		}
+
+		const game::workshop_data* find_mod(const std::string& pub_id)
+		{
+			const auto slot = workshop_index.access<std::optional<unsigned int>>([&](const content_index& index)
+				-> std::optional<unsigned int>
+				{
+					const auto entry = index.mods.find(pub_id);
+					if (entry == index.mods.end())
+					{
+						return {};
+					}
+
+					return entry->second;
+				});
+
+			if (!slot || *slot >= *game::modsCount || game::modsPool[*slot].publisherId != pub_id)
+			{
+				return nullptr;
+			}
+
+			return &game::modsPool[*slot];
+		}
+
 		void dlc_popup_thread_func()
 		{
 			while (true)
@@ -90,16 +186,7 @@ namespace workshop
 
 		bool has_mod(const std::string& pub_id)
 		{
-			for (unsigned int i = 0; i < *game::modsCount; ++i)
-			{
-				const auto& mod_data = game::modsPool[i];
-				if (mod_data.publisherId == pub_id)
-				{
-					return true;
-				}
-			}
-
-			return false;
+			return find_mod(pub_id) != nullptr;
 		}
 
 		void load_usermap_mod_if_needed()
@@ -121,76 +208,73 @@ namespace workshop
 			setup_server_map_hook.invoke(localClientNum, map, gametype);
 		}
 
-		void load_workshop_data(game::workshop_data& item)
+		void load_workshop_data(game::workshop_data* pool, const unsigned int count)
 		{
-			const auto base_path = item.absolutePathZoneFiles;
-			const auto path = utils::string::va("%s/workshop.json", base_path);
-			const auto json_str = utils::io::read_file(path);
+			std::vector<game::workshop_data*> entries{};
+			std::vector<std::filesystem::path> files{};
 
-			if (json_str.empty())
+			for (unsigned int i = 0; i < count; ++i)
 			{
-				printf("[ Workshop ] workshop.json has not been found in folder:\n%s\n", path);
-				return;
-			}
+				auto& item = pool[i];
 
-			rapidjson::Document doc;
-			const rapidjson::ParseResult parse_result = doc.Parse(json_str);
+				// foldername == title -> non-steam workshop usercontent
+				if (std::strcmp(item.folderName, item.title) != 0)
+				{
+					continue;
+				}
 
-			if (parse_result.IsError() || !doc.IsObject())
-			{
-				printf("[ Workshop ] Unable to parse workshop.json from folder:\n%s\n", path);
-				return;
+				entries.emplace_back(&item);
+				files.emplace_back(utils::string::va("%s/workshop.json", item.absolutePathZoneFiles));
 			}
 
-			if (!doc.HasMember("Title") ||
-				!doc.HasMember("Description") ||
-				!doc.HasMember("FolderName") ||
-				!doc.HasMember("PublisherID"))
-			{
-				printf("[ Workshop ] workshop.json is invalid:\n%s\n", path);
-				return;
-			}
+			const auto items = workshop_scanner::load_items(files);
 
-			utils::string::copy(item.title, doc["Title"].GetString());
-			utils::string::copy(item.description, doc["Description"].GetString());
-			utils::string::copy(item.folderName, doc["FolderName"].GetString());
-			utils::string::copy(item.publisherId, doc["PublisherID"].GetString());
-			item.publisherIdInteger = std::strtoul(item.publisherId, nullptr, 10);
-		}
+			for (size_t i = 0; i < entries.size(); ++i)
+			{
+				auto& item = *entries[i];
+				const auto path = files[i].string();
 
-		void load_usermap_content_stub(void* usermaps_count, int type)
-		{
-			utils::hook::invoke<void>(game::select(0x1420D6430, 0x1404E2360), usermaps_count, type);
+				if (!items[i])
+				{
+					if (!utils::io::file_exists(path))
+					{
+						printf("[ Workshop ] workshop.json has not been found in folder:\n%s\n", path.data());
+					}
 
-			for (unsigned int i = 0; i < *game::usermapsCount; ++i)
-			{
-				auto& usermap_data = game::usermapsPool[i];
+					continue;
+				}
 
-				// foldername == title -> non-steam workshop usercontent
-				if (std::strcmp(usermap_data.folderName, usermap_data.title) != 0)
+				const auto& data = *items[i];
+				if (!data.complete)
 				{
+					printf("[ Workshop ] workshop.json is invalid:\n%s\n", path.data());
 					continue;
 				}
 
-				load_workshop_data(usermap_data);
+				utils::string::copy(item.title, data.title.data());
+				utils::string::copy(item.description, data.description.data());
+				utils::string::copy(item.folderName, data.folder_name.data());
+				utils::string::copy(item.publisherId, data.publisher_id.data());
+				item.publisherIdInteger = std::strtoul(item.publisherId, nullptr, 10);
 			}
+
+			workshop_scanner::save_cache();
 		}
 
-		void load_mod_content_stub(void* mods_count, int type)
+		void load_usermap_content_stub(void* usermaps_count, int type)
 		{
-			utils::hook::invoke<void>(game::select(0x1420D6430, 0x1404E2360), mods_count, type);
+			utils::hook::invoke<void>(game::select(0x1420D6430, 0x1404E2360), usermaps_count, type);
 
-			for (unsigned int i = 0; i < *game::modsCount; ++i)
-			{
-				auto& mod_data = game::modsPool[i];
+			load_workshop_data(game::usermapsPool, *game::usermapsCount);
+			index_usermaps();
+		}
 
-				if (std::strcmp(mod_data.folderName, mod_data.title) != 0)
-				{
-					continue;
-				}
+		void load_mod_content_stub(void* mods_count, int type)
+		{
+			utils::hook::invoke<void>(game::select(0x1420D6430, 0x1404E2360), mods_count, type);
 
-				load_workshop_data(mod_data);
-			}
+			load_workshop_data(game::modsPool, *game::modsCount);
+			index_mods();
 		}
 
 		game::workshop_data* load_usermap_stub(const char* map_arg)
@@ -252,15 +336,9 @@ namespace workshop
 
 		std::string mod_name = loaded_mod_id;
 
-		for (unsigned int i = 0; i < *game::modsCount; ++i)
+		if (const auto* mod_data = find_mod(loaded_mod_id))
 		{
-			const auto& mod_data = game::modsPool[i];
-
-			if (mod_data.publisherId == loaded_mod_id)
-			{
-				mod_name = mod_data.title;
-				break;
-			}
+			mod_name = mod_data->title;
 		}
 
 		if (mod_name.size() > 31)
@@ -273,23 +351,20 @@ namespace workshop
 
 	std::string get_usermap_publisher_id(const std::string& zone_name)
 	{
-		for (unsigned int i = 0; i < *game::usermapsCount; ++i)
+		const auto* usermap_data = find_usermap(zone_name);
+		if (!usermap_data)
 		{
-			const auto& usermap_data = game::usermapsPool[i];
-			if (usermap_data.folderName == zone_name)
-			{
-				if (!utils::string::is_numeric(usermap_data.publisherId))
-				{
-					printf(
-						"[ Workshop ] WARNING: The publisherId is not numerical you might have set your usermap folder incorrectly!\n%s\n",
-						usermap_data.absolutePathZoneFiles);
-				}
+			return {};
+		}
 
-				return usermap_data.publisherId;
-			}
+		if (!utils::string::is_numeric(usermap_data->publisherId))
+		{
+			printf(
+				"[ Workshop ] WARNING: The publisherId is not numerical you might have set your usermap folder incorrectly!\n%s\n",
+				usermap_data->absolutePathZoneFiles);
 		}
 
-		return {};
+		return usermap_data->publisherId;
 	}
 
 	int get_workshop_retry_attempts()
@@ -479,6 +554,9 @@ namespace workshop
 			command::add("userContentReload", [](const command::params& params)
 			{
 				game::reloadUserContent();
+
+				index_usermaps();
+				index_mods();
 			});
 			command::add("workshop_config", [](const command::params& params)
 			{
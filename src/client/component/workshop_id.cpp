@@ -7,6 +7,8 @@
 #include <utils/flags.hpp>
 #include <game/game.hpp>
 
+#include "workshop_scanner.hpp"
+
 namespace workshop_id
 {
 	namespace
@@ -90,69 +92,6 @@ namespace workshop_id
 			return 0;
 		}
 
-		void read_json_for_id(std::filesystem::path path)
-		{
-			const auto json_str = utils::io::read_file(path);
-
-			if (json_str.empty())
-			{
-				printf("[ WorkshopID ] workshop.json has not been found in folder \n");
-				return;
-			}
-
-			rapidjson::Document doc;
-			const rapidjson::ParseResult parse_result = doc.Parse(json_str);
-
-			if (parse_result.IsError() || !doc.IsObject())
-			{
-				printf("[ WorkshopID ] Unable to parse workshop.json from folder \n");
-				return;
-			}
-
-			if (!doc.HasMember("PublisherID"))
-			{
-				printf("[ WorkshopID ] PublisherID not found workshop.json is invalid \n");
-				return;
-			}
-
-			std::string pubID = doc["PublisherID"].GetString();
-			write_pubid_to_file(pubID);
-		}
-
-		bool read_json_for_folder_name(std::filesystem::path path, std::string mapname)
-		{
-			const auto json_str = utils::io::read_file(path);
-
-			if (json_str.empty())
-			{
-				printf("[ FolderName ] workshop.json has not been found in folder \n");
-				return false;
-			}
-
-			rapidjson::Document doc;
-			const rapidjson::ParseResult parse_result = doc.Parse(json_str);
-
-			if (parse_result.IsError() || !doc.IsObject())
-			{
-				printf("[ FolderName ] Unable to parse workshop.json from folder \n");
-				return false;
-			}
-
-			if (!doc.HasMember("FolderName"))
-			{
-				printf("[ FolderName ] FolderName not found workshop.json is invalid \n");
-				return false;
-			}
-
-			std::string folder_name = doc["FolderName"].GetString();
-			if (mapname == folder_name)
-			{
-				return true;
-			}
-
-			return false;
-		}
-
 		void get_map_id_from_json()
 		{
 			Sleep(20000); //let the custom map load in server
@@ -172,46 +111,12 @@ namespace workshop_id
 				const std::string& usermaps_path = std::filesystem::current_path().string() + "/usermaps";
 				std::string mapname = game::get_dvar_string("mapname");
 
-				for (const auto& entry : std::filesystem::directory_iterator(usermaps_path))
+				workshop_scanner::scan_usermaps(usermaps_path);
+				workshop_scanner::save_cache();
+
+				if (const auto usermap = workshop_scanner::find_usermap(mapname))
 				{
-					std::filesystem::path workshop_json = entry.path() / "workshop.json";
-					std::filesystem::path workshop_json_zone = entry.path() / "zone/workshop.json";
-
-					if (entry.is_directory() && entry.path().filename() == mapname.data())
-					{
-						if (std::filesystem::exists(workshop_json) && !std::filesystem::is_directory(workshop_json))
-						{
-							read_json_for_id(workshop_json);
-							break;
-						}
-
-						if (std::filesystem::exists(workshop_json_zone) && !std::filesystem::is_directory(
-							workshop_json_zone))
-						{
-							read_json_for_id(workshop_json_zone);
-							break;
-						}
-					}
-					else
-					{
-						if (std::filesystem::exists(workshop_json) && !std::filesystem::is_directory(workshop_json))
-						{
-							if (read_json_for_folder_name(workshop_json, mapname))
-							{
-								read_json_for_id(workshop_json);
-								break;
-							}
-						}
-						else if (std::filesystem::exists(workshop_json_zone) && !std::filesystem::is_directory(
-							workshop_json_zone))
-						{
-							if (read_json_for_folder_name(workshop_json_zone, mapname))
-							{
-								read_json_for_id(workshop_json_zone);
-								break;
-							}
-						}
-					}
+					write_pubid_to_file(usermap->publisher_id);
 				}
 			}
 		}
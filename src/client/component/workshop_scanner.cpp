@@ -0,0 +1,338 @@
+#include <std_include.hpp>
+#include "workshop_scanner.hpp"
+
+#include <utils/io.hpp>
+#include <utils/concurrency.hpp>
+#include <utils/thread.hpp>
+
+namespace workshop_scanner
+{
+	namespace
+	{
+		struct cached_item
+		{
+			std::int64_t mtime{};
+			workshop_item item{};
+		};
+
+		struct scanner_state
+		{
+			bool loaded{false};
+			bool dirty{false};
+
+			std::unordered_map<std::string, cached_item> items{}; // workshop.json path -> parsed item
+			std::unordered_map<std::string, std::string> usermaps{}; // map name -> workshop.json path
+		};
+
+		utils::concurrency::container<scanner_state> state;
+
+		std::string get_cache_filename()
+		{
+			return "boiii_players/user/workshop_cache.json";
+		}
+
+		std::string get_key(const std::filesystem::path& file)
+		{
+			return file.lexically_normal().generic_string();
+		}
+
+		std::optional<std::int64_t> get_mtime(const std::filesystem::path& file)
+		{
+			std::error_code ec{};
+			if (!std::filesystem::is_regular_file(file, ec))
+			{
+				return {};
+			}
+
+			const auto mtime = std::filesystem::last_write_time(file, ec);
+			if (ec)
+			{
+				return {};
+			}
+
+			return mtime.time_since_epoch().count();
+		}
+
+		std::string get_string(const rapidjson::Value& object, const char* name)
+		{
+			const auto member = object.FindMember(name);
+			if (member == object.MemberEnd() || !member->value.IsString())
+			{
+				return {};
+			}
+
+			return {member->value.GetString(), member->value.GetStringLength()};
+		}
+
+		std::optional<workshop_item> parse_item(const std::filesystem::path& file)
+		{
+			std::string json_str{};
+			if (!utils::io::read_file(file.string(), &json_str) || json_str.empty())
+			{
+				return {};
+			}
+
+			rapidjson::Document doc;
+			const rapidjson::ParseResult parse_result = doc.Parse(json_str);
+
+			if (parse_result.IsError() || !doc.IsObject())
+			{
+				printf("[ Workshop ] Unable to parse workshop.json from folder:\n%s\n", file.string().data());
+				return {};
+			}
+
+			if (!doc.HasMember("PublisherID"))
+			{
+				printf("[ Workshop ] PublisherID not found, workshop.json is invalid:\n%s\n", file.string().data());
+				return {};
+			}
+
+			workshop_item item{};
+			item.publisher_id = get_string(doc, "PublisherID");
+			item.folder_name = get_string(doc, "FolderName");
+			item.title = get_string(doc, "Title");
+			item.description = get_string(doc, "Description");
+			item.complete = doc.HasMember("Title") && doc.HasMember("Description") && doc.HasMember("FolderName");
+
+			return item;
+		}
+
+		void load_cache(scanner_state& scanner)
+		{
+			if (scanner.loaded)
+			{
+				return;
+			}
+
+			scanner.loaded = true;
+
+			std::string data{};
+			if (!utils::io::read_file(get_cache_filename(), &data))
+			{
+				return;
+			}
+
+			rapidjson::Document doc{};
+			doc.Parse(data.data(), data.size());
+
+			if (!doc.IsArray())
+			{
+				return;
+			}
+
+			for (const auto& element : doc.GetArray())
+			{
+				if (!element.IsArray() || element.Size() != 7 || !element[0].IsString() || !element[1].IsInt64() ||
+					!element[2].IsString() || !element[3].IsString() || !element[4].IsString() ||
+					!element[5].IsString() || !element[6].IsBool())
+				{
+					continue;
+				}
+
+				cached_item entry{};
+				entry.mtime = element[1].GetInt64();
+				entry.item.publisher_id.assign(element[2].GetString(), element[2].GetStringLength());
+				entry.item.folder_name.assign(element[3].GetString(), element[3].GetStringLength());
+				entry.item.title.assign(element[4].GetString(), element[4].GetStringLength());
+				entry.item.description.assign(element[5].GetString(), element[5].GetStringLength());
+				entry.item.complete = element[6].GetBool();
+
+				scanner.items[std::string(element[0].GetString(), element[0].GetStringLength())] = std::move(entry);
+			}
+		}
+
+		std::optional<workshop_item> load_item(const std::filesystem::path& file)
+		{
+			const auto mtime = get_mtime(file);
+			if (!mtime)
+			{
+				return {};
+			}
+
+			const auto key = get_key(file);
+
+			auto cached = state.access<std::optional<workshop_item>>([&](scanner_state& scanner)
+				-> std::optional<workshop_item>
+				{
+					load_cache(scanner);
+
+					const auto entry = scanner.items.find(key);
+					if (entry == scanner.items.end() || entry->second.mtime != *mtime)
+					{
+						return {};
+					}
+
+					return entry->second.item;
+				});
+
+			if (cached)
+			{
+				return cached;
+			}
+
+			auto item = parse_item(file);
+			if (!item)
+			{
+				return {};
+			}
+
+			state.access([&](scanner_state& scanner)
+			{
+				scanner.items[key] = {*mtime, *item};
+				scanner.dirty = true;
+			});
+
+			return item;
+		}
+
+		std::optional<std::filesystem::path> find_workshop_json(const std::filesystem::path& folder)
+		{
+			std::error_code ec{};
+
+			for (const auto* name : {"workshop.json", "zone/workshop.json"})
+			{
+				auto file = folder / name;
+				if (std::filesystem::is_regular_file(file, ec))
+				{
+					return {std::move(file)};
+				}
+			}
+
+			return {};
+		}
+	}
+
+	std::vector<std::optional<workshop_item>> load_items(const std::vector<std::filesystem::path>& files)
+	{
+		std::vector<std::optional<workshop_item>> items(files.size());
+
+		utils::thread::run_parallel(files.size(), [&](const size_t index)
+		{
+			items[index] = load_item(files[index]);
+		});
+
+		return items;
+	}
+
+	void scan_usermaps(const std::filesystem::path& usermaps_path)
+	{
+		std::vector<std::filesystem::path> folders{};
+
+		std::error_code ec{};
+		for (const auto& entry : std::filesystem::directory_iterator(usermaps_path, ec))
+		{
+			if (entry.is_directory(ec))
+			{
+				folders.emplace_back(entry.path());
+			}
+		}
+
+		std::vector<std::optional<std::filesystem::path>> files(folders.size());
+		std::vector<std::optional<workshop_item>> items(folders.size());
+
+		utils::thread::run_parallel(folders.size(), [&](const size_t index)
+		{
+			files[index] = find_workshop_json(folders[index]);
+			if (files[index])
+			{
+				items[index] = load_item(*files[index]);
+			}
+		});
+
+		std::unordered_map<std::string, std::string> usermaps{};
+
+		// Folder names take precedence over the FolderName declared in workshop.json
+		for (size_t i = 0; i < folders.size(); ++i)
+		{
+			if (items[i])
+			{
+				usermaps.try_emplace(folders[i].filename().string(), get_key(*files[i]));
+			}
+		}
+
+		for (size_t i = 0; i < folders.size(); ++i)
+		{
+			if (items[i] && !items[i]->folder_name.empty())
+			{
+				usermaps.try_emplace(items[i]->folder_name, get_key(*files[i]));
+			}
+		}
+
+		state.access([&](scanner_state& scanner)
+		{
+			scanner.usermaps = std::move(usermaps);
+		});
+	}
+
+	std::optional<workshop_item> find_usermap(const std::string& mapname)
+	{
+		return state.access<std::optional<workshop_item>>([&](const scanner_state& scanner)
+			-> std::optional<workshop_item>
+			{
+				const auto usermap = scanner.usermaps.find(mapname);
+				if (usermap == scanner.usermaps.end())
+				{
+					return {};
+				}
+
+				const auto entry = scanner.items.find(usermap->second);
+				if (entry == scanner.items.end())
+				{
+					return {};
+				}
+
+				return entry->second.item;
+			});
+	}
+
+	void save_cache()
+	{
+		const auto items = state.access<std::optional<std::unordered_map<std::string, cached_item>>>(
+			[](scanner_state& scanner) -> std::optional<std::unordered_map<std::string, cached_item>>
+			{
+				if (!scanner.dirty)
+				{
+					return {};
+				}
+
+				scanner.dirty = false;
+				return scanner.items;
+			});
+
+		if (!items)
+		{
+			return;
+		}
+
+		rapidjson::StringBuffer buffer{};
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+		writer.StartArray();
+
+		for (const auto& [file, entry] : *items)
+		{
+			// Drop entries of items that have been removed since
+			if (get_mtime(file) != entry.mtime)
+			{
+				continue;
+			}
+
+			writer.StartArray();
+			writer.String(file.data(), static_cast<rapidjson::SizeType>(file.size()));
+			writer.Int64(entry.mtime);
+			writer.String(entry.item.publisher_id.data(),
+			              static_cast<rapidjson::SizeType>(entry.item.publisher_id.size()));
+			writer.String(entry.item.folder_name.data(),
+			              static_cast<rapidjson::SizeType>(entry.item.folder_name.size()));
+			writer.String(entry.item.title.data(), static_cast<rapidjson::SizeType>(entry.item.title.size()));
+			writer.String(entry.item.description.data(),
+			              static_cast<rapidjson::SizeType>(entry.item.description.size()));
+			writer.Bool(entry.item.complete);
+			writer.EndArray();
+		}
+
+		writer.EndArray();
+
+		utils::io::write_file(get_cache_filename(), std::string(buffer.GetString(), buffer.GetSize()), false);
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <std_include.hpp>
+
+namespace workshop_scanner
+{
+	struct workshop_item
+	{
+		std::string publisher_id{};
+		std::string folder_name{};
+		std::string title{};
+		std::string description{};
+
+		// Title, Description and FolderName are all present
+		bool complete{};
+	};
+
+	// Parses the given workshop.json files in parallel, unchanged files are served from the cache
+	std::vector<std::optional<workshop_item>> load_items(const std::vector<std::filesystem::path>& files);
+
+	void scan_usermaps(const std::filesystem::path& usermaps_path);
+	std::optional<workshop_item> find_usermap(const std::string& mapname);
+
+	void save_cache();
+}
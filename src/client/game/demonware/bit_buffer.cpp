@@ -91,36 +91,52 @@ namespace demonware
 		return this->write(5, &data);
 	}
 
+	namespace
+	{
+		// Bits are moved through a 64-bit register, at most 7 pending bits plus 56 new ones
+		constexpr unsigned int chunk_bits = 56;
+
+		uint64_t get_mask(const unsigned int bits)
+		{
+			return bits >= 64 ? ~0ull : (1ull << bits) - 1;
+		}
+
+		unsigned int get_bytes(const unsigned int bits)
+		{
+			return (bits + 7) >> 3;
+		}
+	}
+
 	bool bit_buffer::read(unsigned int bits, void* output)
 	{
 		if (bits == 0) return false;
 		if ((this->current_bit_ + bits) > (this->buffer_.size() * 8)) return false;
 
-		int cur_byte = this->current_bit_ >> 3;
-		auto cur_out = 0;
+		const auto* bytes = reinterpret_cast<const unsigned char*>(this->buffer_.data());
+		auto* output_bytes = static_cast<unsigned char*>(output);
 
-		const char* bytes = this->buffer_.data();
-		const auto output_bytes = static_cast<unsigned char*>(output);
+		// Aligned reads are plain copies
+		if ((this->current_bit_ & 7) == 0 && (bits & 7) == 0)
+		{
+			std::memcpy(output_bytes, bytes + (this->current_bit_ >> 3), bits >> 3);
+			this->current_bit_ += bits;
+			return true;
+		}
 
 		while (bits > 0)
 		{
-			const int min_bit = (bits < 8) ? bits : 8;
-			const auto this_byte = bytes[cur_byte++] & 0xFF;
-			const int remain = this->current_bit_ & 7;
+			const auto this_read = std::min(bits, chunk_bits);
+			const auto bit_pos = this->current_bit_ & 7;
 
-			if ((min_bit + remain) <= 8)
-			{
-				output_bytes[cur_out] = static_cast<BYTE>((0xFF >> (8 - min_bit)) & (this_byte >> remain));
-			}
-			else
-			{
-				output_bytes[cur_out] = static_cast<BYTE>((0xFF >> (8 - min_bit)) & (bytes[cur_byte] << (8 - remain)) |
-					(this_byte >> remain));
-			}
+			uint64_t value = 0;
+			std::memcpy(&value, bytes + (this->current_bit_ >> 3), get_bytes(bit_pos + this_read));
+			value = (value >> bit_pos) & get_mask(this_read);
 
-			cur_out++;
-			this->current_bit_ += min_bit;
-			bits -= min_bit;
+			std::memcpy(output_bytes, &value, get_bytes(this_read));
+
+			output_bytes += this_read >> 3;
+			this->current_bit_ += this_read;
+			bits -= this_read;
 		}
 
 		return true;
@@ -129,41 +145,78 @@ namespace demonware
 	bool bit_buffer::write(const unsigned int bits, const void* data)
 	{
 		if (bits == 0) return false;
-		this->buffer_.resize(this->buffer_.size() + (bits >> 3) + 1);
+		this->ensure_size(this->current_bit_ + bits);
 
-		int bit = bits;
-		const auto bytes = this->buffer_.data();
+		auto* bytes = reinterpret_cast<unsigned char*>(this->buffer_.data());
 		const auto* input_bytes = static_cast<const unsigned char*>(data);
 
-		while (bit > 0)
+		auto byte_pos = this->current_bit_ >> 3;
+		auto pending_bits = this->current_bit_ & 7;
+
+		// Keep the bits already written to the current byte
+		uint64_t pending = bytes[byte_pos] & get_mask(pending_bits);
+
+		// Aligned writes of whole bytes are plain copies
+		if (pending_bits == 0 && bits >= 8)
 		{
-			const int bit_pos = this->current_bit_ & 7;
-			auto rem_bit = 8 - bit_pos;
-			const auto this_write = (bit < rem_bit) ? bit : rem_bit;
+			const auto whole_bytes = bits >> 3;
+			std::memcpy(bytes + byte_pos, input_bytes, whole_bytes);
 
-			const BYTE mask = ((0xFF >> rem_bit) | (0xFF << (bit_pos + this_write)));
-			const int byte_pos = this->current_bit_ >> 3;
+			byte_pos += whole_bytes;
+			input_bytes += whole_bytes;
+		}
+
+		auto remaining = pending_bits == 0 ? bits & 7 : bits;
+
+		while (remaining > 0)
+		{
+			const auto this_write = std::min(remaining, chunk_bits);
 
-			const BYTE temp_byte = (mask & bytes[byte_pos]);
-			const BYTE this_bit = ((bits - bit) & 7);
-			const auto this_byte = (bits - bit) >> 3;
+			uint64_t value = 0;
+			std::memcpy(&value, input_bytes, get_bytes(this_write));
 
-			auto this_data = input_bytes[this_byte];
+			pending |= (value & get_mask(this_write)) << pending_bits;
+			pending_bits += this_write;
 
-			const auto next_byte = (((bits - 1) >> 3) > this_byte) ? input_bytes[this_byte + 1] : 0;
+			// Flush whole bytes, keep the rest in the register
+			const auto flush_bytes = pending_bits >> 3;
+			std::memcpy(bytes + byte_pos, &pending, flush_bytes);
 
-			this_data = static_cast<BYTE>((next_byte << (8 - this_bit)) | (this_data >> this_bit));
+			pending = flush_bytes == 8 ? 0 : pending >> (flush_bytes * 8);
+			pending_bits -= flush_bytes * 8;
+			byte_pos += flush_bytes;
 
-			const BYTE out_byte = (~mask & (this_data << bit_pos) | temp_byte);
-			bytes[byte_pos] = out_byte;
+			input_bytes += this_write >> 3;
+			remaining -= this_write;
+		}
 
-			this->current_bit_ += this_write;
-			bit -= this_write;
+		// Bits past the written range in the last byte stay untouched
+		if (pending_bits > 0)
+		{
+			const auto mask = static_cast<unsigned char>(get_mask(pending_bits));
+			bytes[byte_pos] = static_cast<unsigned char>((bytes[byte_pos] & ~mask) | (pending & mask));
 		}
 
+		this->current_bit_ += bits;
 		return true;
 	}
 
+	void bit_buffer::ensure_size(const unsigned int bits)
+	{
+		const size_t required = get_bytes(bits);
+		if (required <= this->buffer_.size())
+		{
+			return;
+		}
+
+		if (required > this->buffer_.capacity())
+		{
+			this->buffer_.reserve(std::max(required, this->buffer_.capacity() * 2));
+		}
+
+		this->buffer_.resize(required);
+	}
+
 	void bit_buffer::set_use_data_types(const bool use_data_types)
 	{
 		this->use_data_types_ = use_data_types;
@@ -33,6 +33,8 @@ namespace demonware
 		std::string& get_buffer();
 
 	private:
+		void ensure_size(unsigned int bits);
+
 		std::string buffer_{};
 		unsigned int current_bit_ = 0;
 		bool use_data_types_ = true;
@@ -0,0 +1,96 @@
+#include <std_include.hpp>
+#include "latency.hpp"
+
+#include <utils/concurrency.hpp>
+#include <utils/string.hpp>
+
+namespace demonware::latency
+{
+	namespace
+	{
+		// Upper bounds of the histogram buckets, the last bucket catches everything above
+		constexpr std::array<std::chrono::microseconds, 8> bucket_limits
+		{
+			100us, 500us, 1ms, 5ms, 10ms, 25ms, 50ms, 100ms,
+		};
+
+		struct histogram
+		{
+			std::array<uint64_t, bucket_limits.size() + 1> buckets{};
+			uint64_t count{0};
+			clock::duration total{};
+			clock::duration max{};
+		};
+
+		utils::concurrency::container<std::map<std::string, histogram>> histograms{};
+
+		size_t get_bucket(const clock::duration duration)
+		{
+			for (size_t i = 0; i < bucket_limits.size(); ++i)
+			{
+				if (duration <= bucket_limits[i])
+				{
+					return i;
+				}
+			}
+
+			return bucket_limits.size();
+		}
+
+		double to_ms(const clock::duration duration)
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+	}
+
+	void record(const std::string& name, const clock::duration duration)
+	{
+		histograms.access([&](std::map<std::string, histogram>& map)
+		{
+			auto& entry = map[name];
+			++entry.buckets[get_bucket(duration)];
+			++entry.count;
+			entry.total += duration;
+			entry.max = std::max(entry.max, duration);
+		});
+	}
+
+	void print()
+	{
+		histograms.access([](const std::map<std::string, histogram>& map)
+		{
+			printf("[DW]: input to reply latency\n");
+
+			std::string header = "name                     count    avg ms    max ms";
+			for (const auto& limit : bucket_limits)
+			{
+				header.append(utils::string::va(" %7s", utils::string::va("<=%lldus", limit.count())));
+			}
+
+			header.append("   >100ms");
+			printf("%s\n", header.data());
+
+			for (const auto& [name, entry] : map)
+			{
+				std::string line = utils::string::va("%-20s %9llu %9.3f %9.3f", name.data(), entry.count,
+				                                     to_ms(entry.total) / static_cast<double>(entry.count),
+				                                     to_ms(entry.max));
+
+				for (const auto& bucket : entry.buckets)
+				{
+					line.append(utils::string::va(" %8llu", bucket));
+				}
+
+				printf("%s\n", line.data());
+			}
+		});
+	}
+
+	void reset()
+	{
+		histograms.access([](std::map<std::string, histogram>& map)
+		{
+			map.clear();
+		});
+	}
+}
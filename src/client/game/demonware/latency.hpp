@@ -0,0 +1,10 @@
+#pragma once
+
+namespace demonware::latency
+{
+	using clock = std::chrono::high_resolution_clock;
+
+	void record(const std::string& name, clock::duration duration);
+	void print();
+	void reset();
+}
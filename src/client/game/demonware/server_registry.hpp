@@ -12,13 +12,17 @@ namespace demonware
 
 	public:
 		template <typename S, typename... Args>
-		void create(Args&&... args)
+		S& create(Args&&... args)
 		{
 			static_assert(std::is_base_of_v<T, S>, "Invalid server type");
 
 			auto server = std::make_unique<S>(std::forward<Args>(args)...);
+			auto& result = *server;
+
 			const auto address = server->get_address();
 			servers_[address] = std::move(server);
+
+			return result;
 		}
 
 		void for_each(const std::function<void(T&)>& callback) const
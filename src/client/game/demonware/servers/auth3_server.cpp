@@ -26,6 +26,51 @@ namespace demonware
 			char m_hash[4];
 		};
 #pragma pack(pop)
+
+		bool is_http_request(const std::string_view& data)
+		{
+			for (const std::string_view method : {"POST ", "GET "})
+			{
+				const auto length = std::min(data.size(), method.size());
+				if (data.substr(0, length) == method.substr(0, length))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		size_t get_content_length(const std::string_view& headers)
+		{
+			const auto lower_headers = utils::string::to_lower(std::string{headers});
+
+			const auto header = lower_headers.find("\r\ncontent-length:");
+			if (header == std::string::npos)
+			{
+				return 0;
+			}
+
+			return std::strtoull(lower_headers.data() + header + 17, nullptr, 10);
+		}
+	}
+
+	size_t auth3_server::get_message_size(const std::string_view& data) const
+	{
+		// Anything that isn't HTTP is handled chunk by chunk, like before
+		if (!is_http_request(data))
+		{
+			return data.size();
+		}
+
+		const auto header_end = data.find("\r\n\r\n");
+		if (header_end == std::string_view::npos)
+		{
+			return 0;
+		}
+
+		const auto message_size = header_end + 4 + get_content_length(data.substr(0, header_end));
+		return data.size() >= message_size ? message_size : 0;
 	}
 
 	void auth3_server::send_reply(reply* data)
@@ -36,12 +81,21 @@ namespace demonware
 
 	void auth3_server::handle(const std::string& packet)
 	{
+		std::string_view body = packet;
+
 		if (packet.starts_with("POST /auth/"))
 		{
 #ifndef NDEBUG
 			printf("[DW]: [auth]: user requested authentication.\n");
 #endif
-			return;
+
+			const auto header_end = packet.find("\r\n\r\n");
+			body = header_end == std::string::npos ? std::string_view{} : body.substr(header_end + 4);
+
+			if (body.empty())
+			{
+				return;
+			}
 		}
 
 		unsigned int title_id = 0;
@@ -50,7 +104,7 @@ namespace demonware
 		std::string token{};
 
 		rapidjson::Document j;
-		j.Parse(packet.data(), packet.size());
+		j.Parse(body.data(), body.size());
 
 		if (j.HasMember("title_id") && j["title_id"].IsString())
 		{
@@ -12,5 +12,6 @@ namespace demonware
 	private:
 		void send_reply(reply* data);
 		void handle(const std::string& packet) override;
+		size_t get_message_size(const std::string_view& data) const override;
 	};
 }
@@ -19,4 +19,17 @@ namespace demonware
 	{
 		return this->address_;
 	}
+
+	void base_server::set_input_notifier(input_notifier notifier)
+	{
+		this->input_notifier_ = std::move(notifier);
+	}
+
+	void base_server::notify_input() const
+	{
+		if (this->input_notifier_)
+		{
+			this->input_notifier_();
+		}
+	}
 }
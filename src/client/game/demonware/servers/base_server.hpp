@@ -5,8 +5,7 @@ namespace demonware
 	class base_server
 	{
 	public:
-		using stream_queue = std::queue<char>;
-		using data_queue = std::queue<std::string>;
+		using input_notifier = std::function<void()>;
 
 		base_server(std::string name);
 
@@ -21,10 +20,16 @@ namespace demonware
 
 		uint32_t get_address() const;
 
+		void set_input_notifier(input_notifier notifier);
+
 		virtual void frame() = 0;
 
+	protected:
+		void notify_input() const;
+
 	private:
 		std::string name_;
 		std::uint32_t address_ = 0;
+		input_notifier input_notifier_{};
 	};
 }
@@ -42,7 +42,10 @@ namespace demonware
 	void lobby_server::send_reply(reply* data)
 	{
 		if (!data) return;
-		this->send(data->data());
+
+		auto buffer = data->data();
+		this->reply_bytes_ += buffer.size();
+		this->send(std::move(buffer));
 	}
 
 	void lobby_server::handle(const std::string& packet)
@@ -163,13 +166,39 @@ namespace demonware
 		}
 	}
 
+	size_t lobby_server::get_message_size(const std::string_view& data) const
+	{
+		// Frames are prefixed with the size of their payload, keep-alives are a bare zero size
+		int32_t size{};
+		if (data.size() < sizeof(size))
+		{
+			return 0;
+		}
+
+		std::memcpy(&size, data.data(), sizeof(size));
+		if (size <= 0)
+		{
+			return sizeof(size);
+		}
+
+		const auto frame_size = sizeof(size) + static_cast<size_t>(size);
+		return data.size() >= frame_size ? frame_size : 0;
+	}
+
 	void lobby_server::call_service(const uint8_t id, const std::string& data)
 	{
-		const auto& it = this->services_.find(id);
+		auto* service = this->services_[id].get();
 
-		if (it != this->services_.end())
+		if (service)
 		{
-			it->second->exec_task(this, data);
+			this->reply_bytes_ = 0;
+
+			const auto start = latency::clock::now();
+			const auto task_id = service->exec_task(this, data);
+			const auto end = latency::clock::now();
+
+			service->record_task(task_id, end - start, this->reply_bytes_);
+			latency::record(service->name(), end - this->get_packet_time());
 		}
 		else
 		{
@@ -183,4 +212,30 @@ namespace demonware
 			this->create_reply(task_id).send();
 		}
 	}
+
+	void lobby_server::print_stats() const
+	{
+		printf("[DW]: service task statistics\n");
+		printf("%-22s %4s %9s %9s %9s %10s %10s\n", "service", "task", "calls", "avg ms", "peak ms", "avg reply",
+		       "peak reply");
+
+		for (const auto& service : this->services_)
+		{
+			if (service)
+			{
+				service->print_stats();
+			}
+		}
+	}
+
+	void lobby_server::reset_stats()
+	{
+		for (const auto& service : this->services_)
+		{
+			if (service)
+			{
+				service->reset_stats();
+			}
+		}
+	}
 }
@@ -24,10 +24,15 @@ namespace demonware
 
 		void send_reply(reply* data) override;
 
+		void print_stats() const;
+		void reset_stats();
+
 	private:
-		std::unordered_map<uint8_t, std::unique_ptr<service>> services_;
+		std::array<std::unique_ptr<service>, 256> services_{};
+		size_t reply_bytes_{0};
 
 		void handle(const std::string& packet) override;
+		size_t get_message_size(const std::string_view& data) const override;
 		void call_service(uint8_t id, const std::string& data);
 	};
 }
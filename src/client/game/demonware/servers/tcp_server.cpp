@@ -3,41 +3,104 @@
 
 namespace demonware
 {
+	namespace
+	{
+		constexpr size_t MAX_PENDING_INPUT = 0x100000;
+	}
+
 	void tcp_server::handle_input(const char* buf, size_t size)
 	{
-		in_queue_.access([&](data_queue& queue)
+		const auto time = latency::clock::now();
+
+		const auto decoded = in_stream_.access<bool>([&](input_stream& stream)
 		{
-			queue.emplace(buf, size);
+			stream.buffer.append(buf, size);
+
+			auto result = false;
+			while (stream.offset < stream.buffer.size())
+			{
+				const auto data = std::string_view(stream.buffer).substr(stream.offset);
+				const auto message_size = std::min(this->get_message_size(data), data.size());
+				if (!message_size)
+				{
+					break;
+				}
+
+				in_queue_.access([&](data_queue& queue)
+				{
+					in_packet p;
+					p.data = std::string{data.substr(0, message_size)};
+					p.time = time;
+
+					queue.emplace(std::move(p));
+				});
+
+				stream.offset += message_size;
+				result = true;
+			}
+
+			const auto remaining = stream.buffer.size() - stream.offset;
+			if (!remaining || remaining > MAX_PENDING_INPUT)
+			{
+				if (remaining)
+				{
+					printf("[DW]: [%s]: dropping %zu bytes of incomplete input\n", this->get_name().data(), remaining);
+				}
+
+				stream.buffer.clear();
+				stream.offset = 0;
+			}
+			else if (stream.offset > stream.buffer.size() / 2)
+			{
+				// Compact once the consumed part dominates, keeps appends amortized
+				stream.buffer.erase(0, stream.offset);
+				stream.offset = 0;
+			}
+
+			return result;
 		});
+
+		if (decoded)
+		{
+			this->notify_input();
+		}
 	}
 
 	size_t tcp_server::handle_output(char* buf, size_t size)
 	{
-		if (out_queue_.get_raw().empty())
+		if (!this->output_ready_.load(std::memory_order_acquire))
 		{
 			return 0;
 		}
 
 		return out_queue_.access<size_t>([&](stream_queue& queue)
 		{
-			for (size_t i = 0; i < size; ++i)
+			size_t copied = 0;
+
+			while (copied < size && !queue.segments.empty())
 			{
-				if (queue.empty())
+				const auto& segment = queue.segments.front();
+				const auto copy_size = std::min(size - copied, segment.size() - queue.offset);
+
+				std::memcpy(buf + copied, segment.data() + queue.offset, copy_size);
+				copied += copy_size;
+				queue.offset += copy_size;
+
+				if (queue.offset >= segment.size())
 				{
-					return i;
+					queue.segments.pop_front();
+					queue.offset = 0;
 				}
-
-				buf[i] = queue.front();
-				queue.pop();
 			}
 
-			return size;
+			this->output_ready_.store(!queue.segments.empty(), std::memory_order_release);
+			return copied;
 		});
 	}
 
-	bool tcp_server::pending_data()
+	bool tcp_server::pending_data() const
 	{
-		return !this->out_queue_.get_raw().empty();
+		return this->output_ready_.load(std::memory_order_acquire);
 	}
 
 	void tcp_server::frame()
@@ -49,7 +112,7 @@ namespace demonware
 
 		while (true)
 		{
-			std::string packet{};
+			in_packet packet{};
 			const auto result = this->in_queue_.access<bool>([&](data_queue& queue)
 			{
 				if (queue.empty())
@@ -67,18 +130,43 @@ namespace demonware
 				break;
 			}
 
-			this->handle(packet);
+			this->packet_time_ = packet.time;
+			this->handle(packet.data);
+
+			latency::record(this->get_name(), latency::clock::now() - packet.time);
 		}
 	}
 
-	void tcp_server::send(const std::string& data)
+	void tcp_server::reset_input()
+	{
+		in_stream_.access([](input_stream& stream)
+		{
+			stream.buffer.clear();
+			stream.offset = 0;
+		});
+	}
+
+	size_t tcp_server::get_message_size(const std::string_view& data) const
 	{
+		return data.size();
+	}
+
+	latency::clock::time_point tcp_server::get_packet_time() const
+	{
+		return this->packet_time_;
+	}
+
+	void tcp_server::send(std::string data)
+	{
+		if (data.empty())
+		{
+			return;
+		}
+
 		out_queue_.access([&](stream_queue& queue)
 		{
-			for (const auto& val : data)
-			{
-				queue.push(val);
-			}
+			queue.segments.emplace_back(std::move(data));
+			this->output_ready_.store(true, std::memory_order_release);
 		});
 	}
 }
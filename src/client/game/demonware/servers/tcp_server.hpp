@@ -3,6 +3,8 @@
 #include "base_server.hpp"
 #include <utils/concurrency.hpp>
 
+#include "../latency.hpp"
+
 namespace demonware
 {
 	class tcp_server : public base_server
@@ -12,16 +14,53 @@ namespace demonware
 
 		void handle_input(const char* buf, size_t size);
 		size_t handle_output(char* buf, size_t size);
-		bool pending_data();
+		bool pending_data() const;
 		void frame() override;
 
+		void reset_input();
+
 	protected:
 		virtual void handle(const std::string& data) = 0;
 
-		void send(const std::string& data);
+		// Size of the complete message at the start of data, 0 if more data is needed.
+		// By default every chunk written by the game is handled as one message.
+		virtual size_t get_message_size(const std::string_view& data) const;
+
+		void send(std::string data);
+
+		latency::clock::time_point get_packet_time() const;
 
 	private:
+		struct in_packet
+		{
+			std::string data;
+			latency::clock::time_point time;
+		};
+
+		using data_queue = std::queue<in_packet>;
+
+		// Bytes received so far, the offset tracks how much was already decoded into messages
+		struct input_stream
+		{
+			std::string buffer{};
+			size_t offset{0};
+		};
+
+		// Whole replies are queued as segments, the offset tracks
+		// how much of the front segment was already consumed
+		struct stream_queue
+		{
+			std::deque<std::string> segments{};
+			size_t offset{0};
+		};
+
+		utils::concurrency::container<input_stream> in_stream_;
 		utils::concurrency::container<data_queue> in_queue_;
 		utils::concurrency::container<stream_queue> out_queue_;
+
+		// Published whenever the output queue changes, lets select poll without locking
+		std::atomic_bool output_ready_{false};
+
+		latency::clock::time_point packet_time_{};
 	};
 }
@@ -10,9 +10,12 @@ namespace demonware
 			in_packet p;
 			p.data = std::string{buf, size};
 			p.endpoint = std::move(endpoint);
+			p.time = latency::clock::now();
 
 			queue.emplace(std::move(p));
 		});
+
+		this->notify_input();
 	}
 
 	size_t udp_server::handle_output(SOCKET socket, char* buf, size_t size, sockaddr* address, int* addrlen)
@@ -34,6 +37,7 @@ namespace demonware
 
 			auto data = std::move(queue.front());
 			queue.pop();
+			--this->pending_packets_;
 
 			const auto copy_size = std::min(size, data.data.size());
 			std::memcpy(buf, data.data.data(), copy_size);
@@ -46,6 +50,11 @@ namespace demonware
 
 	bool udp_server::pending_data(SOCKET socket)
 	{
+		if (!this->pending_packets_)
+		{
+			return false;
+		}
+
 		return this->out_queue_.access<bool>([&](const socket_queue_map& map)
 		{
 			const auto entry = map.find(socket);
@@ -58,6 +67,11 @@ namespace demonware
 		});
 	}
 
+	bool udp_server::has_pending_data() const
+	{
+		return this->pending_packets_ > 0;
+	}
+
 	void udp_server::send(const endpoint_data& endpoint, std::string data)
 	{
 		out_queue_.access([&](socket_queue_map& map)
@@ -67,6 +81,7 @@ namespace demonware
 			p.address = endpoint.address;
 
 			map[endpoint.socket].emplace(std::move(p));
+			++this->pending_packets_;
 		});
 	}
 
@@ -98,6 +113,8 @@ namespace demonware
 			}
 
 			this->handle(packet.endpoint, std::move(packet.data));
+
+			latency::record(this->get_name(), latency::clock::now() - packet.time);
 		}
 	}
 }
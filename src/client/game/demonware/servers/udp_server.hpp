@@ -3,6 +3,8 @@
 #include "base_server.hpp"
 #include <utils/concurrency.hpp>
 
+#include "../latency.hpp"
+
 namespace demonware
 {
 	class udp_server : public base_server
@@ -32,6 +34,7 @@ namespace demonware
 		void handle_input(const char* buf, size_t size, endpoint_data endpoint);
 		size_t handle_output(SOCKET socket, char* buf, size_t size, sockaddr* address, int* addrlen);
 		bool pending_data(SOCKET socket);
+		bool has_pending_data() const;
 
 		void frame() override;
 
@@ -44,6 +47,7 @@ namespace demonware
 		{
 			std::string data;
 			endpoint_data endpoint;
+			latency::clock::time_point time;
 		};
 
 		struct out_packet
@@ -58,5 +62,6 @@ namespace demonware
 
 		utils::concurrency::container<in_queue> in_queue_;
 		utils::concurrency::container<socket_queue_map> out_queue_;
+		std::atomic<size_t> pending_packets_{0};
 	};
 }
@@ -6,13 +6,32 @@ namespace demonware
 {
 	class service
 	{
-		using callback_t = std::function<void(service_server*, byte_buffer*)>;
+	public:
+		// Only touched by the demonware thread, atomics keep dw_stats readable from the console
+		struct task_stats
+		{
+			std::atomic<uint64_t> calls{0};
+			std::atomic<uint64_t> total_time{0};
+			std::atomic<uint64_t> peak_time{0};
+			std::atomic<uint64_t> reply_bytes{0};
+			std::atomic<uint64_t> peak_reply_bytes{0};
+		};
+
+	private:
+		using task_callback = void (service::*)(service_server*, byte_buffer*);
+		using const_task_callback = void (service::*)(service_server*, byte_buffer*) const;
+
+		struct task
+		{
+			task_callback callback{};
+			const_task_callback const_callback{};
+			task_stats stats{};
+		};
 
 		uint8_t id_;
 		std::string name_;
-		std::mutex mutex_;
 		uint8_t task_id_;
-		std::map<uint8_t, callback_t> tasks_;
+		std::array<task, 256> tasks_{};
 
 	public:
 		virtual ~service() = default;
@@ -39,50 +58,110 @@ namespace demonware
 			return this->task_id_;
 		}
 
-		virtual void exec_task(service_server* server, const std::string& data)
+		// Returns the id of the task that has been dispatched
+		virtual uint8_t exec_task(service_server* server, const std::string& data)
 		{
-			std::lock_guard<std::mutex> _(this->mutex_);
-
 			byte_buffer buffer(data);
 
 			buffer.read_ubyte(&this->task_id_);
 
-			const auto& it = this->tasks_.find(this->task_id_);
+			const auto& task = this->tasks_[this->task_id_];
 
-			if (it != this->tasks_.end())
+			if (!task.callback && !task.const_callback)
 			{
+				printf("[DW] %s: missing task '%d'\n", name_.data(), this->task_id_);
+
+				// return no error
+				server->create_reply(this->task_id_).send();
+				return this->task_id_;
+			}
+
 #ifndef NDEBUG
-				printf("[DW] %s: executing task '%d'\n", name_.data(), this->task_id_);
+			printf("[DW] %s: executing task '%d'\n", name_.data(), this->task_id_);
 #endif
 
-				it->second(server, &buffer);
+			if (task.callback)
+			{
+				(this->*task.callback)(server, &buffer);
 			}
 			else
 			{
-				printf("[DW] %s: missing task '%d'\n", name_.data(), this->task_id_);
+				(this->*task.const_callback)(server, &buffer);
+			}
 
-				// return no error
-				server->create_reply(this->task_id_).send();
+			return this->task_id_;
+		}
+
+		void record_task(const uint8_t task_id, const std::chrono::nanoseconds duration, const size_t reply_size)
+		{
+			auto& stats = this->tasks_[task_id].stats;
+			const auto time = static_cast<uint64_t>(duration.count());
+
+			++stats.calls;
+			stats.total_time += time;
+			stats.reply_bytes += reply_size;
+
+			if (time > stats.peak_time)
+			{
+				stats.peak_time = time;
+			}
+
+			if (reply_size > stats.peak_reply_bytes)
+			{
+				stats.peak_reply_bytes = reply_size;
 			}
 		}
 
-	protected:
-		template <typename Class, typename T, typename... Args>
-		void register_task(const uint8_t id, T (Class::*callback)(Args...) const)
+		void print_stats() const
 		{
-			this->tasks_[id] = [this, callback](Args... args) -> T
+			for (size_t i = 0; i < this->tasks_.size(); ++i)
 			{
-				return (reinterpret_cast<Class*>(this)->*callback)(args...);
-			};
+				const auto& stats = this->tasks_[i].stats;
+				const auto calls = stats.calls.load();
+				if (!calls)
+				{
+					continue;
+				}
+
+				printf("%-22s %4zu %9llu %9.3f %9.3f %10llu %10llu\n", this->name_.data(), i, calls,
+				       static_cast<double>(stats.total_time) / static_cast<double>(calls) / 1000000.0,
+				       static_cast<double>(stats.peak_time) / 1000000.0, stats.reply_bytes / calls,
+				       stats.peak_reply_bytes.load());
+			}
 		}
 
-		template <typename Class, typename T, typename... Args>
-		void register_task(const uint8_t id, T (Class::*callback)(Args...))
+		void reset_stats()
 		{
-			this->tasks_[id] = [this, callback](Args... args) -> T
+			for (auto& task : this->tasks_)
 			{
-				return (reinterpret_cast<Class*>(this)->*callback)(args...);
-			};
+				task.stats.calls = 0;
+				task.stats.total_time = 0;
+				task.stats.peak_time = 0;
+				task.stats.reply_bytes = 0;
+				task.stats.peak_reply_bytes = 0;
+			}
+		}
+
+	protected:
+		// Tasks are resolved into the flat table once and invoked directly
+		template <typename Class>
+		void register_task(const uint8_t id, void (Class::*callback)(service_server*, byte_buffer*) const)
+		{
+			static_assert(std::is_base_of_v<service, Class>, "task must belong to a service");
+
+			auto& task = this->tasks_[id];
+			task.callback = nullptr;
+			task.const_callback = static_cast<const_task_callback>(callback);
+		}
+
+		template <typename Class>
+		void register_task(const uint8_t id, void (Class::*callback)(service_server*, byte_buffer*))
+		{
+			static_assert(std::is_base_of_v<service, Class>, "task must belong to a service");
+
+			auto& task = this->tasks_[id];
+			task.callback = static_cast<task_callback>(callback);
+			task.const_callback = nullptr;
 		}
 	};
 }
@@ -16,12 +16,18 @@ namespace demonware
 	{
 	}
 
-	void bdBandwidthTest::exec_task(service_server* server, const std::string& data)
+	uint8_t bdBandwidthTest::exec_task(service_server* server, const std::string& data)
 	{
+		uint8_t task_id{};
+		byte_buffer request(data);
+		request.read_ubyte(&task_id);
+
 		byte_buffer buffer;
 		buffer.write(sizeof bandwidth_iw6, bandwidth_iw6);
 
 		auto reply = server->create_message(5);
 		reply.send(&buffer, true);
+
+		return task_id;
 	}
 }
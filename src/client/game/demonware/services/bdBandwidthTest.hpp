@@ -8,6 +8,6 @@ namespace demonware
 		bdBandwidthTest();
 
 	private:
-		void exec_task(service_server* server, const std::string& data) override;
+		uint8_t exec_task(service_server* server, const std::string& data) override;
 	};
 }
@@ -2,15 +2,46 @@
 #include "../services.hpp"
 
 #include <utils/nt.hpp>
-#include <utils/io.hpp>
 #include <utils/cryptography.hpp>
 #include <utils/compression.hpp>
 
 #include "resource.hpp"
 #include "game/game.hpp"
 
+#include "../user_storage.hpp"
+
 namespace demonware
 {
+	namespace
+	{
+		// Expressions that only escape dots can be looked up by name instead of being matched
+		std::optional<std::string> get_literal_expression(const std::string& expression)
+		{
+			std::string literal{};
+			literal.reserve(expression.size());
+
+			for (size_t i = 0; i < expression.size(); ++i)
+			{
+				const auto chr = expression[i];
+				if (chr == '\\' && i + 1 < expression.size() && expression[i + 1] == '.')
+				{
+					literal.push_back('.');
+					++i;
+				}
+				else if (std::strchr("\\^$.|?*+()[]{}", chr))
+				{
+					return {};
+				}
+				else
+				{
+					literal.push_back(chr);
+				}
+			}
+
+			return {std::move(literal)};
+		}
+	}
+
 	bdStorage::bdStorage() : service(10, "bdStorage")
 	{
 		this->register_task(20, &bdStorage::list_publisher_files);
@@ -42,45 +73,90 @@ namespace demonware
 			throw std::runtime_error("Publisher resource variant is empty!");
 		}
 
+		const auto index = this->publisher_resources_.size();
 		this->publisher_resources_.emplace_back(std::regex{expression}, std::move(resource));
+
+		if (auto literal = get_literal_expression(expression))
+		{
+			this->exact_publisher_resources_.try_emplace(std::move(*literal), index);
+		}
 	}
 
-	bool bdStorage::load_publisher_resource(const std::string& name, std::string& buffer)
+	std::optional<size_t> bdStorage::find_publisher_resource(const std::string& name) const
 	{
-		for (const auto& resource : this->publisher_resources_)
+		const auto exact = this->exact_publisher_resources_.find(name);
+		if (exact != this->exact_publisher_resources_.end())
 		{
-			if (std::regex_match(name, resource.first))
-			{
-				if (std::holds_alternative<std::string>(resource.second))
-				{
-					buffer = std::get<std::string>(resource.second);
-				}
-				else
-				{
-					buffer = std::get<callback>(resource.second)();
-				}
-
-				if (utils::string::ends_with(name, ".gz"))
-				{
-					buffer = utils::compression::zlib::compress(buffer);
-				}
+			return {exact->second};
+		}
 
-				return true;
+		for (size_t i = 0; i < this->publisher_resources_.size(); ++i)
+		{
+			if (std::regex_match(name, this->publisher_resources_[i].first))
+			{
+				return {i};
 			}
 		}
 
+		return {};
+	}
+
+	const bdStorage::publisher_file* bdStorage::load_publisher_resource(const std::string& name)
+	{
+		auto entry = this->publisher_files_.find(name);
+		if (entry == this->publisher_files_.end())
+		{
+			const auto resource = this->find_publisher_resource(name);
+			if (!resource)
+			{
 #ifndef NDEBUG
-		printf("[DW]: [bdStorage]: missing publisher file: %s\n", name.data());
+				printf("[DW]: [bdStorage]: missing publisher file: %s\n", name.data());
 #endif
 
-		return false;
+				return nullptr;
+			}
+
+			publisher_file file{};
+			file.resource = *resource;
+			file.file_id = *reinterpret_cast<const uint64_t*>(utils::cryptography::sha1::compute(name).data());
+
+			entry = this->publisher_files_.emplace(name, std::move(file)).first;
+		}
+
+		auto& file = entry->second;
+		const auto& resource = this->publisher_resources_[file.resource].second;
+
+		// Callback resources are regenerated on every request, but only recompressed when they changed
+		if (std::holds_alternative<callback>(resource))
+		{
+			auto source = std::get<callback>(resource)();
+			if (!file.valid || source != file.source)
+			{
+				file.source = std::move(source);
+				file.valid = false;
+			}
+		}
+
+		if (!file.valid)
+		{
+			const auto& source = std::holds_alternative<std::string>(resource)
+				                     ? std::get<std::string>(resource)
+				                     : file.source;
+
+			file.data = utils::string::ends_with(name, ".gz")
+				            ? utils::compression::zlib::compress(source)
+				            : source;
+			file.valid = true;
+		}
+
+		return &file;
 	}
 
 	void bdStorage::list_publisher_files(service_server* server, byte_buffer* buffer)
 	{
 		uint32_t date;
 		uint16_t num_results, offset;
-		std::string unk, filename, data;
+		std::string unk, filename;
 
 		buffer->read_string(&unk);
 		buffer->read_uint32(&date);
@@ -94,15 +170,15 @@ namespace demonware
 
 		auto reply = server->create_reply(this->task_id());
 
-		if (this->load_publisher_resource(filename, data))
+		if (const auto* file = this->load_publisher_resource(filename))
 		{
 			auto info = std::make_unique<bdFileInfo>();
 
-			info->file_id = *reinterpret_cast<const uint64_t*>(utils::cryptography::sha1::compute(filename).data());
+			info->file_id = file->file_id;
 			info->filename = filename;
 			info->create_time = 0;
 			info->modified_time = info->create_time;
-			info->file_size = static_cast<uint32_t>(data.size());
+			info->file_size = static_cast<uint32_t>(file->data.size());
 			info->owner_id = 0;
 			info->priv = false;
 
@@ -122,16 +198,14 @@ namespace demonware
 		printf("[DW]: [bdStorage]: loading publisher file: %s\n", filename.data());
 #endif
 
-		std::string data;
-
-		if (this->load_publisher_resource(filename, data))
+		if (const auto* file = this->load_publisher_resource(filename))
 		{
 #ifndef NDEBUG
-			printf("[DW]: [bdStorage]: sending publisher file: %s, size: %lld\n", filename.data(), data.size());
+			printf("[DW]: [bdStorage]: sending publisher file: %s, size: %lld\n", filename.data(), file->data.size());
 #endif
 
 			auto reply = server->create_reply(this->task_id());
-			auto result = std::make_unique<bdFileData>(data);
+			auto result = std::make_unique<bdFileData>(file->data);
 			reply.add(result);
 			reply.send();
 		}
@@ -153,8 +227,7 @@ namespace demonware
 		buffer->read_blob(&data);
 		buffer->read_uint64(&owner);
 
-		const auto path = get_user_file_path(filename);
-		utils::io::write_file(path, data);
+		user_storage::write_file(filename, data);
 
 		auto info = std::make_unique<bdFileInfo>();
 
@@ -171,11 +244,6 @@ namespace demonware
 		reply.send();
 	}
 
-	std::string bdStorage::get_user_file_path(const std::string& name)
-	{
-		return "boiii_players/user/" + name;
-	}
-
 	void bdStorage::upload_files(service_server* server, byte_buffer* buffer) const
 	{
 		uint64_t owner;
@@ -200,8 +268,7 @@ namespace demonware
 			buffer->read_uint32(&unk);
 			buffer->read_bool(&priv);
 
-			const auto path = get_user_file_path(filename);
-			utils::io::write_file(path, data);
+			user_storage::write_file(filename, data);
 
 			auto info = std::make_unique<bdFile2>();
 
@@ -248,8 +315,7 @@ namespace demonware
 			buffer->read_uint32(&version);
 			buffer->read_bool(&priv);
 
-			const auto path = get_user_file_path(filename);
-			utils::io::write_file(path, data);
+			user_storage::write_file(filename, data);
 
 			auto info = std::make_unique<bdContextUserStorageFileInfo>();
 
@@ -312,7 +378,7 @@ namespace demonware
 
 			auto& name = filenames.at(i);
 			std::string filedata;
-			if (utils::io::read_file(get_user_file_path(name), &filedata))
+			if (user_storage::read_file(name, filedata))
 			{
 				entry->filedata = filedata;
 #ifndef NDEBUG
@@ -10,11 +10,24 @@ namespace demonware
 	private:
 		using callback = std::function<std::string()>;
 		using resource_variant = std::variant<std::string, callback>;
+
+		struct publisher_file
+		{
+			size_t resource{};
+			bool valid{false};
+			uint64_t file_id{};
+			std::string source{};
+			std::string data{};
+		};
+
 		std::vector<std::pair<std::regex, resource_variant>> publisher_resources_;
+		std::unordered_map<std::string, size_t> exact_publisher_resources_;
+		std::unordered_map<std::string, publisher_file> publisher_files_;
 
 		void map_publisher_resource(const std::string& expression, INT id);
 		void map_publisher_resource_variant(const std::string& expression, resource_variant resource);
-		bool load_publisher_resource(const std::string& name, std::string& buffer);
+		std::optional<size_t> find_publisher_resource(const std::string& name) const;
+		const publisher_file* load_publisher_resource(const std::string& name);
 
 		void list_publisher_files(service_server* server, byte_buffer* buffer);
 		void get_publisher_file(service_server* server, byte_buffer* buffer);
@@ -23,7 +36,5 @@ namespace demonware
 		void upload_files_new(service_server* server, byte_buffer* buffer) const;
 		void get_files(service_server* server, byte_buffer* buffer) const;
 		void unk12(service_server* server, byte_buffer* buffer) const;
-
-		static std::string get_user_file_path(const std::string& name);
 	};
 }
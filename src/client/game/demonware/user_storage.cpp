@@ -0,0 +1,305 @@
+#include <std_include.hpp>
+#include "user_storage.hpp"
+
+#include <utils/concurrency.hpp>
+#include <utils/io.hpp>
+#include <utils/thread.hpp>
+
+namespace demonware::user_storage
+{
+	namespace
+	{
+		using clock = std::chrono::high_resolution_clock;
+
+		// Writes are held back this long so repeated saves of the same file only hit the disk once
+		constexpr auto write_delay = 500ms;
+
+		// Failed commits are retried with an exponential backoff, files that keep failing are given up on
+		// until they are written again
+		constexpr uint32_t max_commit_attempts = 8;
+		constexpr uint32_t max_backoff_shift = 6;
+
+		struct storage_stats
+		{
+			uint64_t hits{0};
+			uint64_t misses{0};
+			uint64_t writes{0};
+			uint64_t coalesced_writes{0};
+			uint64_t flushed_files{0};
+			uint64_t failed_files{0};
+			uint64_t bytes_written{0};
+			uint64_t flushes{0};
+			clock::duration flush_time{};
+			clock::duration max_flush_time{};
+		};
+
+		struct commit_retry
+		{
+			uint32_t attempts{0};
+			clock::time_point next_attempt{};
+		};
+
+		struct storage
+		{
+			std::unordered_map<std::string, std::shared_ptr<const std::string>> files{};
+			std::unordered_set<std::string> dirty{};
+			std::unordered_map<std::string, commit_retry> retries{};
+			storage_stats stats{};
+		};
+
+		utils::concurrency::container<storage> store{};
+
+		std::mutex flush_mutex{};
+		std::condition_variable write_event{};
+		std::atomic_bool kill_thread{false};
+		std::thread writer_thread{};
+
+		std::string get_path(const std::string& name)
+		{
+			return "boiii_players/user/" + name;
+		}
+
+		double to_ms(const clock::duration duration)
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+
+		bool commit_file(const std::string& name, const std::string& data, const bool report_errors)
+		{
+			const auto path = get_path(name);
+			const auto temp_path = path + ".tmp";
+
+			if (!utils::io::write_file(temp_path, data))
+			{
+				if (report_errors)
+				{
+					printf("[DW]: [storage]: failed to write user file: %s\n", name.data());
+				}
+
+				return false;
+			}
+
+			const auto wide_temp_path = std::filesystem::path(temp_path).wstring();
+			const auto wide_path = std::filesystem::path(path).wstring();
+
+			if (!MoveFileExW(wide_temp_path.data(), wide_path.data(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+			{
+				if (report_errors)
+				{
+					printf("[DW]: [storage]: failed to replace user file: %s (%lu)\n", name.data(), GetLastError());
+				}
+
+				utils::io::remove_file(temp_path);
+				return false;
+			}
+
+			return true;
+		}
+
+		void writer_main()
+		{
+			while (!kill_thread)
+			{
+				store.access_with_lock([](const storage& s, std::unique_lock<std::mutex>& lock)
+				{
+					write_event.wait(lock, [&s]
+					{
+						return kill_thread || !s.dirty.empty();
+					});
+
+					write_event.wait_for(lock, write_delay, []
+					{
+						return kill_thread.load();
+					});
+				});
+
+				flush();
+			}
+		}
+	}
+
+	bool read_file(const std::string& name, std::string& data)
+	{
+		const auto cached = store.access<std::shared_ptr<const std::string>>([&](storage& s)
+		{
+			const auto entry = s.files.find(name);
+			if (entry == s.files.end())
+			{
+				++s.stats.misses;
+				return std::shared_ptr<const std::string>{};
+			}
+
+			++s.stats.hits;
+			return entry->second;
+		});
+
+		if (cached)
+		{
+			data = *cached;
+			return true;
+		}
+
+		std::string file_data{};
+		if (!utils::io::read_file(get_path(name), &file_data))
+		{
+			return false;
+		}
+
+		// A write that raced with the disk read takes precedence
+		const auto file = store.access<std::shared_ptr<const std::string>>([&](storage& s)
+		{
+			return s.files.try_emplace(name, std::make_shared<const std::string>(std::move(file_data))).first->second;
+		});
+
+		data = *file;
+		return true;
+	}
+
+	void write_file(const std::string& name, std::string data)
+	{
+		auto file = std::make_shared<const std::string>(std::move(data));
+
+		store.access([&](storage& s)
+		{
+			s.files[name] = std::move(file);
+
+			++s.stats.writes;
+			if (!s.dirty.emplace(name).second)
+			{
+				++s.stats.coalesced_writes;
+			}
+		});
+
+		write_event.notify_one();
+	}
+
+	void start()
+	{
+		kill_thread = false;
+		writer_thread = utils::thread::create_named_thread("Demonware Storage", writer_main);
+	}
+
+	void stop()
+	{
+		kill_thread = true;
+		write_event.notify_all();
+
+		if (writer_thread.joinable())
+		{
+			writer_thread.join();
+		}
+
+		flush();
+	}
+
+	void flush()
+	{
+		// Serializes commits, so an older snapshot never overwrites a newer one
+		std::lock_guard _(flush_mutex);
+
+		const auto start = clock::now();
+
+		struct pending_file
+		{
+			std::string name{};
+			std::shared_ptr<const std::string> data{};
+			bool first_attempt{};
+		};
+
+		std::vector<pending_file> pending{};
+		store.access([&](storage& s)
+		{
+			pending.reserve(s.dirty.size());
+
+			// Files waiting for their next retry stay dirty
+			std::erase_if(s.dirty, [&](const std::string& name)
+			{
+				const auto retry = s.retries.find(name);
+				if (retry != s.retries.end() && retry->second.next_attempt > start)
+				{
+					return false;
+				}
+
+				pending.emplace_back(pending_file{name, s.files.at(name), retry == s.retries.end()});
+				return true;
+			});
+		});
+
+		if (pending.empty())
+		{
+			return;
+		}
+
+		uint64_t flushed_files = 0;
+		uint64_t bytes_written = 0;
+		std::vector<std::string> committed_files{};
+		std::vector<std::string> failed_files{};
+
+		for (auto& file : pending)
+		{
+			// Only the first failure of a file is reported, retries would repeat it every time
+			if (commit_file(file.name, *file.data, file.first_attempt))
+			{
+				++flushed_files;
+				bytes_written += file.data->size();
+				committed_files.emplace_back(std::move(file.name));
+			}
+			else
+			{
+				failed_files.emplace_back(std::move(file.name));
+			}
+		}
+
+		const auto end = clock::now();
+		const auto duration = end - start;
+
+		store.access([&](storage& s)
+		{
+			for (const auto& name : committed_files)
+			{
+				s.retries.erase(name);
+			}
+
+			// Files that are given up on stay cached, their next write queues them again
+			for (auto& name : failed_files)
+			{
+				auto& retry = s.retries[name];
+				++retry.attempts;
+				retry.next_attempt = end + write_delay * (1u << std::min(retry.attempts, max_backoff_shift));
+
+				if (retry.attempts < max_commit_attempts)
+				{
+					s.dirty.emplace(std::move(name));
+				}
+				else if (retry.attempts == max_commit_attempts)
+				{
+					printf("[DW]: [storage]: giving up on user file: %s\n", name.data());
+				}
+			}
+
+			auto& stats = s.stats;
+			++stats.flushes;
+			stats.flushed_files += flushed_files;
+			stats.failed_files += pending.size() - flushed_files;
+			stats.bytes_written += bytes_written;
+			stats.flush_time += duration;
+			stats.max_flush_time = std::max(stats.max_flush_time, duration);
+		});
+	}
+
+	void print_stats()
+	{
+		store.access([](const storage& s)
+		{
+			const auto& stats = s.stats;
+
+			printf("[DW]: user storage: %zu files cached, %zu pending\n", s.files.size(), s.dirty.size());
+			printf("Reads: %llu hits, %llu misses\n", stats.hits, stats.misses);
+			printf("Writes: %llu (%llu coalesced), %llu files flushed (%llu failed), %llu bytes written\n",
+			       stats.writes, stats.coalesced_writes, stats.flushed_files, stats.failed_files, stats.bytes_written);
+			printf("Flushes: %llu, avg %.3fms, max %.3fms\n", stats.flushes,
+			       stats.flushes ? to_ms(stats.flush_time) / static_cast<double>(stats.flushes) : 0.0,
+			       to_ms(stats.max_flush_time));
+		});
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace demonware::user_storage
+{
+	bool read_file(const std::string& name, std::string& data);
+	void write_file(const std::string& name, std::string data);
+
+	void start();
+	void stop();
+	void flush();
+
+	void print_stats();
+}
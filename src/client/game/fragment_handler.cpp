@@ -6,36 +6,222 @@ namespace game::fragment_handler
 	namespace
 	{
 		constexpr size_t MAX_FRAGMENTS = 100;
+		constexpr size_t MAX_SLOTS = 1024;
+		// Matches the old limit of pending messages per address, bursts of profileInfo messages need the room
+		constexpr size_t MAX_SLOTS_PER_ADDRESS = 100;
+		// Reassembly buffers only grow with the fragments that arrived, these cap what a sender can make us hold.
+		// One address can always complete a single message of the maximum size.
+		constexpr size_t MAX_BYTES_PER_ADDRESS = MAX_FRAGMENTS * MAX_FRAGMENT_SIZE;
+		constexpr size_t MAX_TOTAL_BYTES = 16 * MAX_BYTES_PER_ADDRESS;
+		constexpr auto FRAGMENT_TIMEOUT = 5s;
 
-		using fragments = std::unordered_map<size_t, std::string>;
+		using clock = std::chrono::high_resolution_clock;
 
-		struct fragmented_packet
+		struct slot_key
 		{
+			netadr_t address{};
+			uint64_t id{};
+
+			bool operator==(const slot_key& other) const
+			{
+				return this->id == other.id && this->address == other.address;
+			}
+		};
+
+		struct slot_key_hash
+		{
+			size_t operator()(const slot_key& key) const noexcept
+			{
+				return std::hash<netadr_t>()(key.address) ^ (std::hash<uint64_t>()(key.id) << 1);
+			}
+		};
+
+		struct reassembly_slot
+		{
+			bool used{false};
+			uint32_t generation{0};
+			slot_key key{};
 			size_t fragment_count{0};
-			fragments fragments{};
-			std::chrono::high_resolution_clock::time_point insertion_time = std::chrono::high_resolution_clock::now();
+			size_t fragment_size{0};
+			size_t received_count{0};
+			size_t reserved_bytes{0};
+			std::bitset<MAX_FRAGMENTS> received{};
+			// All fragments but the last are written in place, their size is taken from the first one
+			std::string data{};
+			std::string tail{};
 		};
 
-		using id_fragment_map = std::unordered_map<uint64_t, fragmented_packet>;
-		using address_fragment_map = std::unordered_map<netadr_t, id_fragment_map>;
+		struct expiry_entry
+		{
+			clock::time_point deadline{};
+			size_t slot{};
+			uint32_t generation{};
+		};
 
-		utils::concurrency::container<address_fragment_map> global_map{};
+		struct address_usage
+		{
+			size_t slots{0};
+			size_t bytes{0};
+		};
 
-		std::vector<std::string> construct_fragments(const void* data, const size_t length)
+		struct reassembly_table
 		{
-			std::vector<std::string> fragments{};
+			std::array<reassembly_slot, MAX_SLOTS> slots{};
+			std::vector<size_t> free_slots{};
+			std::unordered_map<slot_key, size_t, slot_key_hash> index{};
+			std::unordered_map<netadr_t, address_usage> addresses{};
+			std::deque<expiry_entry> expiry_queue{};
+			size_t total_bytes{0};
+
+			reassembly_table()
+			{
+				this->free_slots.reserve(MAX_SLOTS);
+				for (size_t i = MAX_SLOTS; i > 0; --i)
+				{
+					this->free_slots.push_back(i - 1);
+				}
+			}
+		};
 
-			constexpr size_t max_fragment_size = 0x400;
+		utils::concurrency::container<reassembly_table> global_table{};
 
-			for (size_t i = 0; i < length; i += max_fragment_size)
+		void release_slot(reassembly_table& table, const size_t index)
+		{
+			auto& slot = table.slots[index];
+
+			table.index.erase(slot.key);
+
+			const auto address_entry = table.addresses.find(slot.key.address);
+			if (address_entry != table.addresses.end())
 			{
-				const auto current_fragment_size = std::min(length - i, max_fragment_size);
+				address_entry->second.bytes -= slot.reserved_bytes;
+				if (--address_entry->second.slots == 0)
+				{
+					table.addresses.erase(address_entry);
+				}
+			}
 
-				std::string fragment(static_cast<const char*>(data) + i, current_fragment_size);
-				fragments.push_back(std::move(fragment));
+			table.total_bytes -= slot.reserved_bytes;
+
+			slot.used = false;
+			++slot.generation;
+			slot.fragment_count = 0;
+			slot.fragment_size = 0;
+			slot.received_count = 0;
+			slot.reserved_bytes = 0;
+			slot.received.reset();
+
+			// Released slots must not keep memory that is no longer counted against the limits
+			std::string{}.swap(slot.data);
+			std::string{}.swap(slot.tail);
+
+			table.free_slots.push_back(index);
+		}
+
+		void expire_slots(reassembly_table& table, const clock::time_point now)
+		{
+			// All slots share the same timeout, so the queue is ordered by deadline
+			while (!table.expiry_queue.empty() && table.expiry_queue.front().deadline <= now)
+			{
+				const auto entry = table.expiry_queue.front();
+				table.expiry_queue.pop_front();
+
+				const auto& slot = table.slots[entry.slot];
+				if (slot.used && slot.generation == entry.generation)
+				{
+					release_slot(table, entry.slot);
+				}
+			}
+		}
+
+		std::optional<size_t> acquire_slot(reassembly_table& table, const slot_key& key, const size_t fragment_count)
+		{
+			const auto entry = table.index.find(key);
+			if (entry != table.index.end())
+			{
+				return {entry->second};
 			}
 
-			return fragments;
+			const auto address_entry = table.addresses.find(key.address);
+			if (table.free_slots.empty() ||
+				(address_entry != table.addresses.end() && address_entry->second.slots >= MAX_SLOTS_PER_ADDRESS))
+			{
+				return {};
+			}
+
+			const auto index = table.free_slots.back();
+			table.free_slots.pop_back();
+
+			++table.addresses[key.address].slots;
+			table.index.emplace(key, index);
+
+			auto& slot = table.slots[index];
+			slot.used = true;
+			slot.key = key;
+			slot.fragment_count = fragment_count;
+
+			table.expiry_queue.push_back({clock::now() + FRAGMENT_TIMEOUT, index, slot.generation});
+
+			return {index};
+		}
+
+		bool reserve_bytes(reassembly_table& table, reassembly_slot& slot, const size_t size)
+		{
+			auto& usage = table.addresses[slot.key.address];
+			if (usage.bytes + size > MAX_BYTES_PER_ADDRESS || table.total_bytes + size > MAX_TOTAL_BYTES)
+			{
+				return false;
+			}
+
+			usage.bytes += size;
+			table.total_bytes += size;
+			slot.reserved_bytes += size;
+			return true;
+		}
+
+		bool store_fragment(reassembly_table& table, reassembly_slot& slot, const size_t fragment_index,
+		                    const std::string_view& fragment)
+		{
+			if (fragment_index + 1 == slot.fragment_count)
+			{
+				if (!reserve_bytes(table, slot, fragment.size()))
+				{
+					return false;
+				}
+
+				slot.tail.assign(fragment);
+				return true;
+			}
+
+			if (!slot.fragment_size)
+			{
+				if (fragment.empty())
+				{
+					return false;
+				}
+
+				slot.fragment_size = fragment.size();
+			}
+
+			if (fragment.size() != slot.fragment_size)
+			{
+				return false;
+			}
+
+			// Only grow as far as the fragments that actually arrived
+			const auto required_size = (fragment_index + 1) * slot.fragment_size;
+			if (required_size > slot.data.size())
+			{
+				if (!reserve_bytes(table, slot, required_size - slot.data.size()))
+				{
+					return false;
+				}
+
+				slot.data.resize(required_size);
+			}
+
+			std::memcpy(slot.data.data() + fragment_index * slot.fragment_size, fragment.data(), fragment.size());
+			return true;
 		}
 	}
 
@@ -45,109 +231,84 @@ namespace game::fragment_handler
 		const size_t fragment_count = buffer.read<uint32_t>();
 		const size_t fragment_index = buffer.read<uint32_t>();
 
-		auto fragment_data = buffer.get_remaining_data();
+		const auto fragment_data = buffer.get_remaining_view();
 
-		if (fragment_index > fragment_count || !fragment_count || fragment_count > MAX_FRAGMENTS)
+		if (fragment_index >= fragment_count || !fragment_count || fragment_count > MAX_FRAGMENTS
+			|| fragment_data.size() > MAX_FRAGMENT_SIZE)
 		{
 			return false;
 		}
 
-		return global_map.access<bool>([&](address_fragment_map& map)
+		return global_table.access<bool>([&](reassembly_table& table)
 		{
-			auto& user_map = map[target];
-			if (!user_map.contains(fragment_id) && user_map.size() > MAX_FRAGMENTS)
+			expire_slots(table, clock::now());
+
+			const auto index = acquire_slot(table, {target, fragment_id}, fragment_count);
+			if (!index)
 			{
 				return false;
 			}
 
-			auto& packet_queue = user_map[fragment_id];
-
-			if (packet_queue.fragment_count == 0)
+			auto& slot = table.slots[*index];
+			if (slot.fragment_count != fragment_count || slot.received[fragment_index])
 			{
-				packet_queue.fragment_count = fragment_count;
+				return false;
 			}
 
-			if (packet_queue.fragment_count != fragment_count)
+			if (!store_fragment(table, slot, fragment_index, fragment_data))
 			{
+				release_slot(table, *index);
 				return false;
 			}
 
-			if (packet_queue.fragments.size() + 1 < fragment_count)
+			slot.received.set(fragment_index);
+			if (++slot.received_count < fragment_count)
 			{
-				packet_queue.fragments[fragment_index] = std::move(fragment_data);
 				return false;
 			}
 
-			final_packet.clear();
-
-			for (size_t i = 0; i < fragment_count; ++i)
+			if (slot.fragment_size && slot.tail.size() > slot.fragment_size)
 			{
-				if (i == fragment_index)
-				{
-					final_packet.append(fragment_data);
-				}
-				else
-				{
-					final_packet.append(packet_queue.fragments.at(i));
-				}
+				release_slot(table, *index);
+				return false;
 			}
 
+			slot.data.append(slot.tail);
+			final_packet = std::move(slot.data);
+
+			release_slot(table, *index);
 			return true;
 		});
 	}
 
 	void clean()
 	{
-		global_map.access([](address_fragment_map& map)
+		global_table.access([](reassembly_table& table)
 		{
-			for (auto i = map.begin(); i != map.end();)
-			{
-				auto& user_map = i->second;
-
-				for (auto j = user_map.begin(); j != user_map.end();)
-				{
-					const auto now = std::chrono::high_resolution_clock::now();
-					const auto diff = now - j->second.insertion_time;
-
-					if (diff > 5s)
-					{
-						j = user_map.erase(j);
-					}
-					else
-					{
-						++j;
-					}
-				}
-
-				if (user_map.empty())
-				{
-					i = map.erase(i);
-				}
-				else
-				{
-					++i;
-				}
-			}
+			expire_slots(table, clock::now());
 		});
 	}
 
-	void fragment_handler::fragment_data(const void* data, const size_t size,
-	                                     const std::function<void(const utils::byte_buffer& buffer)>& callback)
+	void fragment_data(const void* data, const size_t size,
+	                   const std::function<void(const utils::byte_buffer& buffer)>& callback,
+	                   const size_t fragment_size)
 	{
 		static std::atomic_uint64_t current_id{0};
 		const auto id = current_id++;
 
-		const auto fragments = construct_fragments(data, size);
+		const auto max_fragment_size = std::clamp(fragment_size, static_cast<size_t>(1), MAX_FRAGMENT_SIZE);
+		const auto fragment_count = (size + max_fragment_size - 1) / max_fragment_size;
 
-		for (size_t i = 0; i < fragments.size(); ++i)
+		for (size_t i = 0; i < fragment_count; ++i)
 		{
+			const auto offset = i * max_fragment_size;
+			const auto current_fragment_size = std::min(size - offset, max_fragment_size);
+
 			utils::byte_buffer buffer{};
 			buffer.write(id);
-			buffer.write(static_cast<uint32_t>(fragments.size()));
+			buffer.write(static_cast<uint32_t>(fragment_count));
 			buffer.write(static_cast<uint32_t>(i));
-
-			auto& fragment = fragments.at(i);
-			buffer.write(fragment.data(), fragment.size());
+			buffer.write(static_cast<const char*>(data) + offset, current_fragment_size);
 
 			callback(buffer);
 		}
@@ -7,11 +7,15 @@
 
 namespace game::fragment_handler
 {
+	constexpr size_t DEFAULT_FRAGMENT_SIZE = 0x400;
+	constexpr size_t MAX_FRAGMENT_SIZE = 0x4000;
+
 	bool handle(const netadr_t& target, utils::byte_buffer& buffer,
 	            std::string& final_packet);
 
 	void clean();
 
 	void fragment_data(const void* data, size_t size,
-	                   const std::function<void(const utils::byte_buffer& buffer)>& callback);
+	                   const std::function<void(const utils::byte_buffer& buffer)>& callback,
+	                   size_t fragment_size = DEFAULT_FRAGMENT_SIZE);
 }
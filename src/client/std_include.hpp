@@ -73,7 +73,9 @@
 
 #include <array>
 #include <atomic>
+#include <bitset>
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -85,6 +87,7 @@
 #include <queue>
 #include <random>
 #include <regex>
+#include <source_location>
 #include <sstream>
 #include <thread>
 #include <unordered_set>
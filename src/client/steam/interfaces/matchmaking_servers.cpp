@@ -6,6 +6,7 @@
 #include "component/party.hpp"
 #include "component/network.hpp"
 #include "component/server_list.hpp"
+#include "component/scheduler.hpp"
 
 #include <utils/string.hpp>
 #include <utils/concurrency.hpp>
@@ -24,8 +25,11 @@ namespace steam
 		struct server
 		{
 			bool handled{false};
+			bool reported{false};
+			bool notified{false};
 			game::netadr_t address{};
 			gameserveritem_t server_item{};
+			::utils::info_string info{};
 		};
 
 		auto* const internet_request = reinterpret_cast<void*>(1);
@@ -44,6 +48,9 @@ namespace steam
 		std::atomic<matchmaking_server_list_response*> favorites_response{};
 		std::atomic<matchmaking_server_list_response*> history_response{};
 
+		// Set while master servers are still reporting, guarded by internet_servers
+		bool internet_listing{false};
+
 		std::string get_lan_servers_file_path()
 		{
 			return "boiii_players/user/lan_servers.txt";
@@ -225,12 +232,32 @@ namespace steam
 			return server;
 		}
 
+		bool all_servers_handled(const servers& srvs)
+		{
+			for (const auto& entry : srvs)
+			{
+				if (!entry.handled)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
 		void handle_server_respone(const bool success, const game::netadr_t& host, const ::utils::info_string& info,
 		                           const uint32_t ping, ::utils::concurrency::container<servers>& server_list,
-		                           std::atomic<matchmaking_server_list_response*>& response, void* request)
+		                           std::atomic<matchmaking_server_list_response*>& response, void* request,
+		                           const bool* listing = nullptr)
 		{
 			bool all_handled = false;
+			bool changed = true;
 			std::optional<int> index{};
+
+			// The challenge differs for every query, so it is not part of the info that is compared and kept
+			auto server_info = info;
+			server_info.remove("challenge");
+
 			server_list.access([&](servers& srvs)
 			{
 				size_t i = 0;
@@ -253,16 +280,22 @@ namespace steam
 				srv.handled = true;
 				srv.server_item = create_server_item(host, info, ping, success);
 
-
-				for (const auto& entry : srvs)
+				if (success)
 				{
-					if (!entry.handled)
-					{
-						return;
-					}
+					// Entries already notified from the cache are only notified again if their info changed,
+					// the cached report may still be pending when the first reply arrives
+					changed = !srv.notified || srv.info != server_info;
+					srv.reported = true;
+					srv.notified = true;
+					srv.info = std::move(server_info);
+				}
+				else
+				{
+					// Failed servers are not reported as responding from the cache afterwards
+					srv.notified = true;
 				}
 
-				all_handled = true;
+				all_handled = (!listing || !*listing) && all_servers_handled(srvs);
 			});
 
 			const auto res = response.load();
@@ -273,7 +306,10 @@ namespace steam
 
 			if (success)
 			{
-				res->ServerResponded(request, *index);
+				if (changed)
+				{
+					res->ServerResponded(request, *index);
+				}
 			}
 			else
 			{
@@ -290,7 +326,13 @@ namespace steam
 		                                     const ::utils::info_string& info,
 		                                     const uint32_t ping)
 		{
-			handle_server_respone(success, host, info, ping, internet_servers, internet_response, internet_request);
+			if (success)
+			{
+				server_list::cache_server_info(host, info, ping);
+			}
+
+			handle_server_respone(success, host, info, ping, internet_servers, internet_response, internet_request,
+			                      &internet_listing);
 		}
 
 		void handle_lan_server_response(const bool success, const game::netadr_t& host,
@@ -305,6 +347,11 @@ namespace steam
 		                                      const ::utils::info_string& info,
 		                                      const uint32_t ping)
 		{
+			if (success)
+			{
+				server_list::cache_server_info(host, info, ping);
+			}
+
 			handle_server_respone(success, host, info, ping, favorites_servers, favorites_response, favorites_request);
 		}
 
@@ -319,6 +366,48 @@ namespace steam
 		{
 			party::query_server(server, callback);
 		}
+
+		server create_cached_server(const server_list::cached_server& cached)
+		{
+			server new_server{};
+			new_server.address = cached.address;
+			new_server.reported = true;
+			new_server.info = cached.info;
+			new_server.server_item = create_server_item(cached.address, cached.info, cached.ping, true);
+
+			return new_server;
+		}
+
+		void report_cached_servers(::utils::concurrency::container<servers>& server_list,
+		                           std::atomic<matchmaking_server_list_response*>& response, void* request)
+		{
+			scheduler::once([&server_list, &response, request]
+			{
+				std::vector<int> indices{};
+				server_list.access([&indices](servers& srvs)
+				{
+					for (size_t i = 0; i < srvs.size(); ++i)
+					{
+						if (srvs[i].reported && !srvs[i].notified)
+						{
+							srvs[i].notified = true;
+							indices.emplace_back(static_cast<int>(i));
+						}
+					}
+				});
+
+				const auto res = response.load();
+				if (!res)
+				{
+					return;
+				}
+
+				for (const auto index : indices)
+				{
+					res->ServerResponded(request, index);
+				}
+			}, scheduler::async);
+		}
 	}
 
 	void* matchmaking_servers::RequestInternetServerList(unsigned int iApp, void** ppchFilters, unsigned int nFilters,
@@ -326,45 +415,87 @@ namespace steam
 	{
 		internet_response = pRequestServersResponse;
 
-		server_list::request_servers([](const bool success, const std::unordered_set<game::netadr_t>& s)
+		// Known servers are shown from the cache right away and refreshed along with the master list
+		const auto cached_servers = server_list::get_cached_servers();
+
+		internet_servers.access([&cached_servers](servers& srvs)
 		{
-			const auto res = internet_response.load();
-			if (!res)
-			{
-				return;
-			}
+			srvs = {};
+			srvs.reserve(cached_servers.size());
+			internet_listing = true;
 
-			if (!success)
+			for (const auto& cached : cached_servers)
 			{
-				res->RefreshComplete(internet_request, eServerFailedToRespond);
-				return;
+				srvs.push_back(create_cached_server(cached));
 			}
+		});
 
-			if (s.empty())
-			{
-				res->RefreshComplete(internet_request, eNoServersListedOnMasterServer);
-				return;
-			}
+		report_cached_servers(internet_servers, internet_response, internet_request);
+
+		for (const auto& cached : cached_servers)
+		{
+			ping_server(cached.address, handle_internet_server_response);
+		}
+
+		server_list::request_servers([](const std::vector<game::netadr_t>& s)
+		{
+			std::vector<game::netadr_t> new_servers{};
 
-			internet_servers.access([&s](servers& srvs)
+			// Servers are appended as masters report them, indices of existing entries stay stable
+			internet_servers.access([&](servers& srvs)
 			{
-				srvs = {};
-				srvs.reserve(s.size());
+				std::unordered_set<game::netadr_t> known_servers{};
+				for (const auto& srv : srvs)
+				{
+					known_servers.emplace(srv.address);
+				}
+
+				srvs.reserve(srvs.size() + s.size());
 
 				for (auto& address : s)
 				{
+					if (known_servers.contains(address))
+					{
+						continue;
+					}
+
 					server new_server{};
 					new_server.address = address;
 					new_server.server_item = create_server_item(address, {}, 0, false);
 
 					srvs.push_back(new_server);
+					new_servers.emplace_back(address);
 				}
 			});
 
-			for (auto& srv : s)
+			for (auto& srv : new_servers)
 			{
 				ping_server(srv, handle_internet_server_response);
 			}
+		}, [](const bool success)
+		{
+			const auto all_handled = internet_servers.access<bool>([](const servers& srvs)
+			{
+				internet_listing = false;
+				return all_servers_handled(srvs);
+			});
+
+			const auto res = internet_response.load();
+			if (!res)
+			{
+				return;
+			}
+
+			if (!success)
+			{
+				res->RefreshComplete(internet_request, eServerFailedToRespond);
+				return;
+			}
+
+			if (all_handled)
+			{
+				res->RefreshComplete(internet_request, eServerResponded);
+			}
 		});
 
 		return internet_request;
@@ -443,6 +574,12 @@ namespace steam
 
 				for (auto& address : s)
 				{
+					if (const auto cached = server_list::get_cached_server(address))
+					{
+						srvs.push_back(create_cached_server(*cached));
+						continue;
+					}
+
 					server new_server{};
 					new_server.address = address;
 					new_server.server_item = create_server_item(address, {}, 0, false);
@@ -451,6 +588,8 @@ namespace steam
 				}
 			});
 
+			report_cached_servers(favorites_servers, favorites_response, favorites_request);
+
 			for (auto& srv : s)
 			{
 				ping_server(srv, handle_favorites_server_response);
@@ -9,6 +9,7 @@
 #include <utils/http.hpp>
 #include <utils/io.hpp>
 #include <utils/compression.hpp>
+#include <utils/thread.hpp>
 
 #define UPDATE_SERVER "https://r2.ezz.lol/"
 
@@ -81,9 +82,34 @@ namespace updater
 			return parse_file_infos(*json);
 		}
 
-		std::string get_hash(const std::string& data)
+		std::optional<std::string> get_file_hash(const std::filesystem::path& file)
 		{
-			return utils::cryptography::sha1::compute(data, true);
+			// Hashed in chunks, zone files are way too large to be read at once
+			return utils::cryptography::sha1::compute_file(file, true);
+		}
+
+		std::optional<std::pair<std::uint64_t, std::int64_t>> get_file_stats(const std::filesystem::path& file)
+		{
+			std::error_code ec{};
+			const auto size = std::filesystem::file_size(file, ec);
+			if (ec)
+			{
+				return {};
+			}
+
+			const auto mtime = std::filesystem::last_write_time(file, ec);
+			if (ec)
+			{
+				return {};
+			}
+
+			return {{size, mtime.time_since_epoch().count()}};
+		}
+
+		std::filesystem::path get_temp_filename(std::filesystem::path file)
+		{
+			const auto temp_extension = file.extension().string() + ".new";
+			return file.replace_extension(temp_extension);
 		}
 
 		const file_info* find_host_file_info(const std::vector<file_info>& outdated_files)
@@ -191,12 +217,10 @@ namespace updater
 		const auto* host_file = find_host_file_info(files);
 		if (host_file)
 		{
-			std::string data{};
 			const auto drive_name = this->get_drive_filename(*host_file);
-			if (utils::io::read_file(drive_name, &data))
+			if (const auto hash = get_file_hash(drive_name))
 			{
-				const auto hash = get_hash(data);
-				if (hash != host_file->hash)
+				if (*hash != host_file->hash)
 				{
 					if (!utils::flags::has_flag("update"))
 					{
@@ -215,6 +239,7 @@ namespace updater
 
 		this->update_host_binary(outdated_files);
 		this->update_files(outdated_files);
+		this->cache_updated_files(outdated_files);
 
 		std::this_thread::sleep_for(1s);
 	}
@@ -222,100 +247,213 @@ namespace updater
 	void file_updater::update_file(const file_info& file) const
 	{
 		const auto url = get_update_folder() + file.name + "?" + file.hash;
-		OutputDebugStringA(("Downloading: " + file.name + "\n").c_str());
-
-		const auto data = utils::http::get_data(url, {}, [&](const size_t progress)
-		{
-			this->listener_.file_progress(file, progress);
-		});
+		const auto out_file = this->get_drive_filename(file);
+		const auto temp_file = get_temp_filename(out_file);
 
-		if (!data)
+		// A partial download left by an earlier attempt is resumed, unless it can't belong to this file
+		const auto partial = get_file_stats(temp_file);
+		auto resume = partial && partial->first > 0;
+		if (partial && partial->first > file.size)
 		{
-			throw std::runtime_error("Failed to download: " + file.name + " (no data received)");
+			utils::io::remove_file(temp_file);
+			resume = false;
 		}
 
-		if (data->size() != file.size)
+		while (true)
 		{
-			throw std::runtime_error("Failed to download: " + file.name +
-				" (size mismatch: got " + std::to_string(data->size()) +
-				", expected " + std::to_string(file.size) + ")");
+			utils::cryptography::sha1::hasher hasher{};
+
+			if (resume && !hasher.update_file(temp_file))
+			{
+				utils::io::remove_file(temp_file);
+				hasher.init();
+				resume = false;
+			}
+
+			// An earlier attempt may have finished the download without moving it into place,
+			// there is nothing left to request for it
+			if (resume && partial->first == file.size)
+			{
+				if (hasher.finalize(true) == file.hash)
+				{
+					OutputDebugStringA(("Using completed download: " + file.name + "\n").c_str());
+					this->listener_.file_progress(file, file.size);
+					break;
+				}
+
+				utils::io::remove_file(temp_file);
+				resume = false;
+			}
+
+			OutputDebugStringA(((resume ? "Resuming download: " : "Downloading: ") + file.name + "\n").c_str());
+
+			const auto downloaded = utils::http::download_file(
+				url, temp_file, [&](const size_t offset, const void* data, const size_t length)
+				{
+					if (!offset)
+					{
+						hasher.init();
+					}
+
+					hasher.update(data, length);
+				}, {}, [&](const size_t progress)
+				{
+					this->listener_.file_progress(file, progress);
+				});
+
+			if (!downloaded)
+			{
+				throw std::runtime_error("Failed to download: " + file.name + " (no data received)");
+			}
+
+			const auto stats = get_file_stats(temp_file);
+			const auto size = stats ? stats->first : 0;
+
+			if (size == file.size && hasher.finalize(true) == file.hash)
+			{
+				break;
+			}
+
+			utils::io::remove_file(temp_file);
+
+			// The partial file may have come from an older version, try once more from scratch
+			if (resume)
+			{
+				OutputDebugStringA(("Resumed download of " + file.name + " is corrupt, restarting\n").c_str());
+				resume = false;
+				continue;
+			}
+
+			if (size != file.size)
+			{
+				throw std::runtime_error("Failed to download: " + file.name +
+					" (size mismatch: got " + std::to_string(size) +
+					", expected " + std::to_string(file.size) + ")");
+			}
+
+			throw std::runtime_error("Failed to download: " + file.name + " (hash mismatch)");
 		}
 
-		if (get_hash(*data) != file.hash)
+		OutputDebugStringA(("Moving downloaded file to final location: " + out_file.string() + "\n").c_str());
+
+		if (!MoveFileExW(temp_file.wstring().c_str(), out_file.wstring().c_str(),
+		                 MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
 		{
-			throw std::runtime_error("Failed to download: " + file.name + " (hash mismatch)");
+			const DWORD error = GetLastError();
+			throw std::runtime_error("Failed to write: " + file.name + " to " + out_file.string() +
+				" (MoveFileEx failed with error " + std::to_string(error) + ")");
 		}
 
-		const auto out_file = this->get_drive_filename(file);
-		const bool is_exe = file.name.ends_with(".exe") || file.name == UPDATE_HOST_BINARY;
+		OutputDebugStringA(("Successfully updated: " + file.name + "\n").c_str());
+	}
 
-		if (is_exe)
+	std::vector<file_info> file_updater::get_outdated_files(const std::vector<file_info>& files) const
+	{
+		struct hash_job
 		{
-			OutputDebugStringA(("Writing exe to temp file first: " + out_file.string() + "\n").c_str());
+			size_t index{};
+			std::filesystem::path path{};
+			cached_file local{};
+		};
 
-			auto temp_file = out_file;
-			const auto temp_extension = temp_file.extension().string() + ".new";
-			const auto temp_path = temp_file.replace_extension(temp_extension);
+		const auto cache = this->load_manifest_cache();
 
-			if (!utils::io::write_file_executable(temp_path, *data))
-			{
-				throw std::runtime_error("Failed to write temp exe: " + file.name + " to " + temp_path.string());
-			}
+		manifest_cache new_cache{};
+		std::vector<bool> outdated(files.size(), false);
+		std::vector<hash_job> hash_jobs{};
 
-			OutputDebugStringA("Verifying temp exe size and hash...\n");
+		for (size_t i = 0; i < files.size(); ++i)
+		{
+			const auto& file = files[i];
 
-			std::string verify_data{};
-			if (!utils::io::read_file(temp_path, &verify_data))
+#ifndef NDEBUG
+			if (file.name == UPDATE_HOST_BINARY && !utils::flags::has_flag("update"))
 			{
-				throw std::runtime_error("Failed to read back temp exe for verification: " + temp_path.string());
+				OutputDebugStringA("Skipping host binary update in debug build (use -update flag to enable)\n");
+				continue;
 			}
+#endif
 
-			if (verify_data.size() != data->size())
+			const auto drive_name = this->get_drive_filename(file);
+			const auto stats = get_file_stats(drive_name);
+			if (!stats)
 			{
-				throw std::runtime_error("Temp exe size mismatch after write: expected " +
-					std::to_string(data->size()) + ", got " + std::to_string(verify_data.size()));
+				OutputDebugStringA(("File not found, marking as outdated: " + file.name + "\n").c_str());
+				outdated[i] = true;
+				continue;
 			}
 
-			if (get_hash(verify_data) != file.hash)
+			if (stats->first != file.size)
 			{
-				throw std::runtime_error("Temp exe hash mismatch after write");
+				OutputDebugStringA(("Size mismatch for " + file.name + ": local=" + std::to_string(stats->first) +
+					", remote=" + std::to_string(file.size) + "\n").c_str());
+				outdated[i] = true;
+				continue;
 			}
 
-			OutputDebugStringA(("Moving temp exe to final location: " + out_file.string() + "\n").c_str());
-
-			if (!MoveFileExW(temp_path.wstring().c_str(), out_file.wstring().c_str(),
-			                 MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+			// Unchanged files keep the hash computed on a previous launch
+			const auto entry = cache.find(file.name);
+			if (entry != cache.end() && entry->second.size == stats->first && entry->second.mtime == stats->second)
 			{
-				const DWORD error = GetLastError();
-				throw std::runtime_error("Failed to replace exe: " + file.name +
-					" (MoveFileEx failed with error " + std::to_string(error) + ")");
+				new_cache[file.name] = entry->second;
+				if (entry->second.hash != file.hash)
+				{
+					OutputDebugStringA(("Hash mismatch for " + file.name + "\n").c_str());
+					outdated[i] = true;
+				}
+
+				continue;
 			}
 
-			OutputDebugStringA(("Successfully replaced executable: " + file.name + "\n").c_str());
+			hash_job job{};
+			job.index = i;
+			job.path = drive_name;
+			job.local.size = stats->first;
+			job.local.mtime = stats->second;
+
+			hash_jobs.emplace_back(std::move(job));
 		}
-		else
+
+		if (!hash_jobs.empty())
 		{
-			OutputDebugStringA(("Writing to: " + out_file.string() + "\n").c_str());
+			OutputDebugStringA(("Hashing " + std::to_string(hash_jobs.size()) + " changed files\n").c_str());
 
-			if (!utils::io::write_file(out_file, *data, false))
+			utils::thread::run_parallel(hash_jobs.size(), [&](const size_t index)
 			{
-				throw std::runtime_error("Failed to write: " + file.name + " to " + out_file.string() +
-					" (file may be locked or read-only)");
+				auto& job = hash_jobs[index];
+				job.local.hash = get_file_hash(job.path).value_or(std::string{});
+			});
+		}
+
+		for (const auto& job : hash_jobs)
+		{
+			const auto& file = files[job.index];
+
+			if (job.local.hash.empty())
+			{
+				OutputDebugStringA(("Failed to read " + file.name + ", marking as outdated\n").c_str());
+				outdated[job.index] = true;
+				continue;
 			}
 
-			OutputDebugStringA(("Successfully updated: " + file.name + "\n").c_str());
+			new_cache[file.name] = job.local;
+
+			if (job.local.hash != file.hash)
+			{
+				OutputDebugStringA(("Hash mismatch for " + file.name + "\n").c_str());
+				outdated[job.index] = true;
+			}
 		}
-	}
 
-	std::vector<file_info> file_updater::get_outdated_files(const std::vector<file_info>& files) const
-	{
+		this->save_manifest_cache(new_cache);
+
 		std::vector<file_info> outdated_files{};
 
-		for (const auto& info : files)
+		for (size_t i = 0; i < files.size(); ++i)
 		{
-			if (this->is_outdated_file(info))
+			if (outdated[i])
 			{
-				outdated_files.emplace_back(info);
+				outdated_files.emplace_back(files[i]);
 			}
 		}
 
@@ -351,22 +489,18 @@ namespace updater
 					this->update_files({*host_file});
 					OutputDebugStringA("Exe update successful!\n");
 
+					// The download was hashed while streaming, only make sure it ended up in place
 					OutputDebugStringA("Verifying final exe file...\n");
-					std::string verify_data{};
-					if (!utils::io::read_file(this->process_file_, &verify_data))
+					const auto stats = get_file_stats(this->process_file_);
+					if (!stats)
 					{
-						throw std::runtime_error("Failed to read updated exe for verification");
+						throw std::runtime_error("Failed to find updated exe for verification");
 					}
 
-					if (verify_data.size() != host_file->size)
+					if (stats->first != host_file->size)
 					{
 						throw std::runtime_error("Updated exe size mismatch: expected " +
-							std::to_string(host_file->size) + ", got " + std::to_string(verify_data.size()));
-					}
-
-					if (get_hash(verify_data) != host_file->hash)
-					{
-						throw std::runtime_error("Updated exe hash mismatch");
+							std::to_string(host_file->size) + ", got " + std::to_string(stats->first));
 					}
 
 					OutputDebugStringA("Final exe verification passed!\n");
@@ -411,108 +545,115 @@ namespace updater
 
 		const auto thread_count = get_optimal_concurrent_download_count(outdated_files.size());
 
-		std::vector<std::thread> threads{};
-		std::atomic<size_t> current_index{0};
+		utils::thread::run_parallel(outdated_files.size(), thread_count, [&](const size_t index)
+		{
+			const auto& file = outdated_files[index];
+			this->listener_.begin_file(file);
+			this->update_file(file);
+			this->listener_.end_file(file);
+		});
 
-		utils::concurrency::container<std::exception_ptr> exception{};
+		this->listener_.done_update();
+	}
 
-		for (size_t i = 0; i < thread_count; ++i)
+	std::filesystem::path file_updater::get_drive_filename(const file_info& file) const
+	{
+		if (file.name == UPDATE_HOST_BINARY)
 		{
-			threads.emplace_back([&]()
-			{
-				while (!exception.access<bool>([](const std::exception_ptr& ptr)
-				{
-					return static_cast<bool>(ptr);
-				}))
-				{
-					const auto index = current_index++;
-					if (index >= outdated_files.size())
-					{
-						break;
-					}
+			return this->process_file_;
+		}
 
-					try
-					{
-						const auto& file = outdated_files[index];
-						this->listener_.begin_file(file);
-						this->update_file(file);
-						this->listener_.end_file(file);
-					}
-					catch (...)
-					{
-						exception.access([](std::exception_ptr& ptr)
-						{
-							ptr = std::current_exception();
-						});
+		return this->base_ / file.name;
+	}
 
-						return;
-					}
-				}
-			});
+	std::filesystem::path file_updater::get_manifest_cache_filename() const
+	{
+		// The user folder is left alone by the directory cleanup
+		return this->base_ / "user" / "file_cache.json";
+	}
+
+	file_updater::manifest_cache file_updater::load_manifest_cache() const
+	{
+		std::string data{};
+		if (!utils::io::read_file(this->get_manifest_cache_filename(), &data))
+		{
+			return {};
 		}
 
-		for (auto& thread : threads)
+		rapidjson::Document doc{};
+		doc.Parse(data.data(), data.size());
+
+		if (!doc.IsArray())
 		{
-			if (thread.joinable())
-			{
-				thread.join();
-			}
+			return {};
 		}
 
-		exception.access([](const std::exception_ptr& ptr)
+		manifest_cache cache{};
+
+		for (const auto& element : doc.GetArray())
 		{
-			if (ptr)
+			if (!element.IsArray() || element.Size() != 4 || !element[0].IsString() || !element[1].IsUint64() ||
+				!element[2].IsInt64() || !element[3].IsString())
 			{
-				std::rethrow_exception(ptr);
+				continue;
 			}
-		});
 
-		this->listener_.done_update();
+			cached_file file{};
+			file.size = element[1].GetUint64();
+			file.mtime = element[2].GetInt64();
+			file.hash.assign(element[3].GetString(), element[3].GetStringLength());
+
+			cache[std::string(element[0].GetString(), element[0].GetStringLength())] = std::move(file);
+		}
+
+		return cache;
 	}
 
-	bool file_updater::is_outdated_file(const file_info& file) const
+	void file_updater::save_manifest_cache(const manifest_cache& cache) const
 	{
-#ifndef NDEBUG
-		if (file.name == UPDATE_HOST_BINARY && !utils::flags::has_flag("update"))
-		{
-			OutputDebugStringA("Skipping host binary update in debug build (use -update flag to enable)\n");
-			return false;
-		}
-#endif
+		rapidjson::StringBuffer buffer{};
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
 
-		std::string data{};
-		const auto drive_name = this->get_drive_filename(file);
-		if (!utils::io::read_file(drive_name, &data))
-		{
-			OutputDebugStringA(("File not found, marking as outdated: " + file.name + "\n").c_str());
-			return true;
-		}
+		writer.StartArray();
 
-		if (data.size() != file.size)
+		for (const auto& [name, file] : cache)
 		{
-			OutputDebugStringA(("Size mismatch for " + file.name + ": local=" + std::to_string(data.size()) +
-				", remote=" + std::to_string(file.size) + "\n").c_str());
-			return true;
+			writer.StartArray();
+			writer.String(name.data(), static_cast<rapidjson::SizeType>(name.size()));
+			writer.Uint64(file.size);
+			writer.Int64(file.mtime);
+			writer.String(file.hash.data(), static_cast<rapidjson::SizeType>(file.hash.size()));
+			writer.EndArray();
 		}
 
-		const auto hash = get_hash(data);
-		if (hash != file.hash)
-		{
-			OutputDebugStringA(("Hash mismatch for " + file.name + "\n").c_str());
-			return true;
-		}
+		writer.EndArray();
 
-		return false;
+		utils::io::write_file(this->get_manifest_cache_filename().string(),
+		                      std::string(buffer.GetString(), buffer.GetSize()), false);
 	}
 
-	std::filesystem::path file_updater::get_drive_filename(const file_info& file) const
+	void file_updater::cache_updated_files(const std::vector<file_info>& updated_files) const
 	{
-		if (file.name == UPDATE_HOST_BINARY)
+		auto cache = this->load_manifest_cache();
+
+		// Downloaded files were verified against the manifest hash, no need to hash them again
+		for (const auto& file : updated_files)
 		{
-			return this->process_file_;
+			const auto stats = get_file_stats(this->get_drive_filename(file));
+			if (!stats)
+			{
+				continue;
+			}
+
+			cached_file entry{};
+			entry.size = stats->first;
+			entry.mtime = stats->second;
+			entry.hash = file.hash;
+
+			cache[file.name] = std::move(entry);
 		}
 
-		return this->base_ / file.name;
+		this->save_manifest_cache(cache);
 	}
 
 	void file_updater::move_current_process_file() const
@@ -626,7 +767,8 @@ namespace updater
 			bool found = false;
 			for (const auto& wantedFile : files)
 			{
-				if (wantedFile.name == entry)
+				// Partial downloads are kept so they can be resumed
+				if (wantedFile.name == entry || get_temp_filename(wantedFile.name) == entry)
 				{
 					found = true;
 					break;
@@ -656,6 +798,7 @@ namespace updater
 			if (file.name.starts_with("data"))
 			{
 				legal_files.emplace_back(std::filesystem::absolute(base / file.name));
+				legal_files.emplace_back(std::filesystem::absolute(get_temp_filename(base / file.name)));
 			}
 		}
 
@@ -17,6 +17,15 @@ namespace updater
 		void update_files(const std::vector<file_info>& outdated_files) const;
 
 	private:
+		struct cached_file
+		{
+			std::uint64_t size{};
+			std::int64_t mtime{};
+			std::string hash{};
+		};
+
+		using manifest_cache = std::unordered_map<std::string, cached_file>;
+
 		progress_listener& listener_;
 
 		std::filesystem::path base_;
@@ -25,9 +34,13 @@ namespace updater
 
 		void update_file(const file_info& file) const;
 
-		[[nodiscard]] bool is_outdated_file(const file_info& file) const;
 		[[nodiscard]] std::filesystem::path get_drive_filename(const file_info& file) const;
 
+		[[nodiscard]] std::filesystem::path get_manifest_cache_filename() const;
+		[[nodiscard]] manifest_cache load_manifest_cache() const;
+		void save_manifest_cache(const manifest_cache& cache) const;
+		void cache_updated_files(const std::vector<file_info>& updated_files) const;
+
 		void move_current_process_file() const;
 		void restore_current_process_file() const;
 		void delete_old_process_file() const;
@@ -131,6 +131,11 @@ namespace utils
 			return this->read_data(this->get_remaining_size());
 		}
 
+		std::string_view get_remaining_view() const
+		{
+			return std::string_view(this->buffer_).substr(this->offset_);
+		}
+
 		std::string read_data(size_t length);
 
 	private:
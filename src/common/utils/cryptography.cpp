@@ -2,6 +2,7 @@
 #include "cryptography.hpp"
 
 #include <random>
+#include <fstream>
 
 #include "nt.hpp"
 #include "finally.hpp"
@@ -137,6 +138,75 @@ namespace utils::cryptography
 		const prng prng_(fortuna_desc);
 	}
 
+	hasher::hasher(const ltc_hash_descriptor& descriptor)
+		: descriptor_(descriptor)
+	{
+		this->init();
+	}
+
+	void hasher::init()
+	{
+		this->descriptor_.init(&this->state_);
+	}
+
+	void hasher::update(const void* data, size_t length)
+	{
+		// Feed large buffers in pieces, the length is an unsigned long
+		constexpr size_t max_length = 0x40000000;
+
+		const auto* buffer = static_cast<const uint8_t*>(data);
+		while (length > 0)
+		{
+			const auto current_length = std::min(length, max_length);
+			this->descriptor_.process(&this->state_, buffer, ul(current_length));
+
+			buffer += current_length;
+			length -= current_length;
+		}
+	}
+
+	void hasher::update(const std::string& data)
+	{
+		this->update(data.data(), data.size());
+	}
+
+	std::string hasher::finalize(const bool hex)
+	{
+		uint8_t buffer[MAXBLOCKSIZE] = {0};
+		this->descriptor_.done(&this->state_, buffer);
+		this->init();
+
+		std::string hash(cs(buffer), this->descriptor_.hashsize);
+		if (!hex) return hash;
+
+		return string::dump_hex(hash, "");
+	}
+
+	bool hasher::update_file(const std::filesystem::path& file)
+	{
+		std::ifstream stream(file, std::ios::binary);
+		if (!stream.is_open())
+		{
+			return false;
+		}
+
+		std::string buffer{};
+		buffer.resize(1024 * 1024);
+
+		while (stream)
+		{
+			stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+			const auto count = stream.gcount();
+			if (count > 0)
+			{
+				this->update(buffer.data(), static_cast<size_t>(count));
+			}
+		}
+
+		return !stream.bad();
+	}
+
 	ecc::key::key()
 	{
 		ZeroMemory(&this->key_storage_, sizeof(this->key_storage_));
@@ -465,6 +535,11 @@ namespace utils::cryptography
 		return dec_data;
 	}
 
+	tiger::hasher::hasher()
+		: cryptography::hasher(tiger_desc)
+	{
+	}
+
 	std::string tiger::compute(const std::string& data, const bool hex)
 	{
 		return compute(cs(data.data()), data.size(), hex);
@@ -472,17 +547,20 @@ namespace utils::cryptography
 
 	std::string tiger::compute(const uint8_t* data, const size_t length, const bool hex)
 	{
-		uint8_t buffer[24] = {0};
-
-		hash_state state;
-		tiger_init(&state);
-		tiger_process(&state, data, ul(length));
-		tiger_done(&state, buffer);
+		hasher state{};
+		state.update(data, length);
+		return state.finalize(hex);
+	}
 
-		std::string hash(cs(buffer), sizeof(buffer));
-		if (!hex) return hash;
+	std::optional<std::string> tiger::compute_file(const std::filesystem::path& file, const bool hex)
+	{
+		hasher state{};
+		if (!state.update_file(file))
+		{
+			return {};
+		}
 
-		return string::dump_hex(hash, "");
+		return state.finalize(hex);
 	}
 
 	std::string aes::encrypt(const std::string& data, const std::string& iv, const std::string& key)
@@ -537,6 +615,11 @@ namespace utils::cryptography
 		return buffer;
 	}
 
+	sha1::hasher::hasher()
+		: cryptography::hasher(sha1_desc)
+	{
+	}
+
 	std::string sha1::compute(const std::string& data, const bool hex)
 	{
 		return compute(cs(data.data()), data.size(), hex);
@@ -544,17 +627,25 @@ namespace utils::cryptography
 
 	std::string sha1::compute(const uint8_t* data, const size_t length, const bool hex)
 	{
-		uint8_t buffer[20] = {0};
+		hasher state{};
+		state.update(data, length);
+		return state.finalize(hex);
+	}
 
-		hash_state state;
-		sha1_init(&state);
-		sha1_process(&state, data, ul(length));
-		sha1_done(&state, buffer);
+	std::optional<std::string> sha1::compute_file(const std::filesystem::path& file, const bool hex)
+	{
+		hasher state{};
+		if (!state.update_file(file))
+		{
+			return {};
+		}
 
-		std::string hash(cs(buffer), sizeof(buffer));
-		if (!hex) return hash;
+		return state.finalize(hex);
+	}
 
-		return string::dump_hex(hash, "");
+	sha256::hasher::hasher()
+		: cryptography::hasher(sha256_desc)
+	{
 	}
 
 	std::string sha256::compute(const std::string& data, const bool hex)
@@ -564,17 +655,25 @@ namespace utils::cryptography
 
 	std::string sha256::compute(const uint8_t* data, const size_t length, const bool hex)
 	{
-		uint8_t buffer[32] = {0};
+		hasher state{};
+		state.update(data, length);
+		return state.finalize(hex);
+	}
 
-		hash_state state;
-		sha256_init(&state);
-		sha256_process(&state, data, ul(length));
-		sha256_done(&state, buffer);
+	std::optional<std::string> sha256::compute_file(const std::filesystem::path& file, const bool hex)
+	{
+		hasher state{};
+		if (!state.update_file(file))
+		{
+			return {};
+		}
 
-		std::string hash(cs(buffer), sizeof(buffer));
-		if (!hex) return hash;
+		return state.finalize(hex);
+	}
 
-		return string::dump_hex(hash, "");
+	sha512::hasher::hasher()
+		: cryptography::hasher(sha512_desc)
+	{
 	}
 
 	std::string sha512::compute(const std::string& data, const bool hex)
@@ -584,17 +683,20 @@ namespace utils::cryptography
 
 	std::string sha512::compute(const uint8_t* data, const size_t length, const bool hex)
 	{
-		uint8_t buffer[64] = {0};
-
-		hash_state state;
-		sha512_init(&state);
-		sha512_process(&state, data, ul(length));
-		sha512_done(&state, buffer);
+		hasher state{};
+		state.update(data, length);
+		return state.finalize(hex);
+	}
 
-		std::string hash(cs(buffer), sizeof(buffer));
-		if (!hex) return hash;
+	std::optional<std::string> sha512::compute_file(const std::filesystem::path& file, const bool hex)
+	{
+		hasher state{};
+		if (!state.update_file(file))
+		{
+			return {};
+		}
 
-		return string::dump_hex(hash, "");
+		return state.finalize(hex);
 	}
 
 	std::string base64::encode(const uint8_t* data, const size_t len)
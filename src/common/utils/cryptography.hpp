@@ -1,10 +1,30 @@
 #pragma once
 
 #include <string>
+#include <optional>
+#include <filesystem>
 #include <tomcrypt.h>
 
 namespace utils::cryptography
 {
+	// Incremental hashing, finalize() resets the state so the object can be reused
+	class hasher
+	{
+	public:
+		explicit hasher(const ltc_hash_descriptor& descriptor);
+
+		void init();
+		void update(const void* data, size_t length);
+		void update(const std::string& data);
+		std::string finalize(bool hex = false);
+
+		bool update_file(const std::filesystem::path& file);
+
+	private:
+		const ltc_hash_descriptor& descriptor_;
+		hash_state state_{};
+	};
+
 	namespace ecc
 	{
 		class key final
@@ -66,8 +86,15 @@ namespace utils::cryptography
 
 	namespace tiger
 	{
+		class hasher final : public cryptography::hasher
+		{
+		public:
+			hasher();
+		};
+
 		std::string compute(const std::string& data, bool hex = false);
 		std::string compute(const uint8_t* data, size_t length, bool hex = false);
+		std::optional<std::string> compute_file(const std::filesystem::path& file, bool hex = false);
 	}
 
 	namespace aes
@@ -83,20 +110,41 @@ namespace utils::cryptography
 
 	namespace sha1
 	{
+		class hasher final : public cryptography::hasher
+		{
+		public:
+			hasher();
+		};
+
 		std::string compute(const std::string& data, bool hex = false);
 		std::string compute(const uint8_t* data, size_t length, bool hex = false);
+		std::optional<std::string> compute_file(const std::filesystem::path& file, bool hex = false);
 	}
 
 	namespace sha256
 	{
+		class hasher final : public cryptography::hasher
+		{
+		public:
+			hasher();
+		};
+
 		std::string compute(const std::string& data, bool hex = false);
 		std::string compute(const uint8_t* data, size_t length, bool hex = false);
+		std::optional<std::string> compute_file(const std::filesystem::path& file, bool hex = false);
 	}
 
 	namespace sha512
 	{
+		class hasher final : public cryptography::hasher
+		{
+		public:
+			hasher();
+		};
+
 		std::string compute(const std::string& data, bool hex = false);
 		std::string compute(const uint8_t* data, size_t length, bool hex = false);
+		std::optional<std::string> compute_file(const std::filesystem::path& file, bool hex = false);
 	}
 
 	namespace base64
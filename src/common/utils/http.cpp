@@ -1,5 +1,6 @@
 #include "http.hpp"
 #include <curl/curl.h>
+#include <fstream>
 #include "finally.hpp"
 
 #pragma comment(lib, "ws2_32.lib")
@@ -12,6 +13,15 @@ namespace utils::http
 		{
 			const std::function<void(size_t)>* callback{};
 			std::exception_ptr exception{};
+			size_t offset{0};
+		};
+
+		struct download_helper
+		{
+			const data_callback* callback{};
+			std::ofstream stream{};
+			size_t offset{0};
+			std::exception_ptr exception{};
 		};
 
 		int progress_callback(void* clientp, const curl_off_t /*dltotal*/, const curl_off_t dlnow,
@@ -23,7 +33,7 @@ namespace utils::http
 			{
 				if (*helper->callback)
 				{
-					(*helper->callback)(dlnow);
+					(*helper->callback)(helper->offset + static_cast<size_t>(dlnow));
 				}
 			}
 			catch (...)
@@ -43,51 +53,91 @@ namespace utils::http
 			buffer->append(static_cast<char*>(contents), total_size);
 			return total_size;
 		}
+
+		size_t download_callback(void* contents, const size_t size, const size_t nmemb, void* userp)
+		{
+			auto* helper = static_cast<download_helper*>(userp);
+			const auto total_size = size * nmemb;
+
+			try
+			{
+				helper->stream.write(static_cast<const char*>(contents), static_cast<std::streamsize>(total_size));
+				if (!helper->stream)
+				{
+					return 0;
+				}
+
+				if (*helper->callback)
+				{
+					(*helper->callback)(helper->offset, contents, total_size);
+				}
+
+				helper->offset += total_size;
+			}
+			catch (...)
+			{
+				helper->exception = std::current_exception();
+				return 0;
+			}
+
+			return total_size;
+		}
+
+		void setup_request(CURL* curl, const std::string& url, curl_slist* header_list, progress_helper* helper)
+		{
+			curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+			curl_easy_setopt(curl, CURLOPT_URL, url.data());
+			curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
+			curl_easy_setopt(curl, CURLOPT_XFERINFODATA, helper);
+			curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+			curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+			curl_easy_setopt(curl, CURLOPT_USERAGENT, "ezz-updater/1.0");
+			curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+			curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+			curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+			// Request raw data without encoding modifications
+			curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "identity");
+		}
+
+		curl_slist* create_header_list(const headers& headers)
+		{
+			curl_slist* header_list = nullptr;
+
+			for (const auto& header : headers)
+			{
+				auto data = header.first + ": " + header.second;
+				header_list = curl_slist_append(header_list, data.data());
+			}
+
+			// Add Accept header for binary data to prevent CDN content modification
+			return curl_slist_append(header_list, "Accept: application/octet-stream");
+		}
 	}
 
 	std::optional<std::string> get_data(const std::string& url, const headers& headers,
 	                                    const std::function<void(size_t)>& callback, const uint32_t retries)
 	{
-		curl_slist* header_list = nullptr;
 		auto* curl = curl_easy_init();
 		if (!curl)
 		{
 			return {};
 		}
 
+		auto* header_list = create_header_list(headers);
+
 		auto _ = finally([&]()
 		{
 			curl_slist_free_all(header_list);
 			curl_easy_cleanup(curl);
 		});
 
-		for (const auto& header : headers)
-		{
-			auto data = header.first + ": " + header.second;
-			header_list = curl_slist_append(header_list, data.data());
-		}
-
 		std::string buffer{};
 		progress_helper helper{};
 		helper.callback = &callback;
 
-		// Add Accept header for binary data to prevent CDN content modification
-		header_list = curl_slist_append(header_list, "Accept: application/octet-stream");
-
-		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
-		curl_easy_setopt(curl, CURLOPT_URL, url.data());
+		setup_request(curl, url, header_list, &helper);
 		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
-		curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
-		curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &helper);
-		curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
-		curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-		curl_easy_setopt(curl, CURLOPT_USERAGENT, "ezz-updater/1.0");
-		curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
-		curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-		curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-		// Request raw data without encoding modifications
-		curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "identity");
 
 		for (auto i = 0u; i < retries + 1; ++i)
 		{
@@ -123,6 +173,103 @@ namespace utils::http
 		return {};
 	}
 
+	bool download_file(const std::string& url, const std::filesystem::path& file, const data_callback& data_callback,
+	                   const headers& headers, const std::function<void(size_t)>& callback, const uint32_t retries)
+	{
+		auto* curl = curl_easy_init();
+		if (!curl)
+		{
+			return false;
+		}
+
+		auto* header_list = create_header_list(headers);
+
+		auto _ = finally([&]()
+		{
+			curl_slist_free_all(header_list);
+			curl_easy_cleanup(curl);
+		});
+
+		std::error_code ec{};
+		if (file.has_parent_path())
+		{
+			std::filesystem::create_directories(file.parent_path(), ec);
+		}
+
+		progress_helper helper{};
+		helper.callback = &callback;
+
+		download_helper download{};
+		download.callback = &data_callback;
+
+		setup_request(curl, url, header_list, &helper);
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, download_callback);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download);
+
+		for (auto i = 0u; i < retries + 1; ++i)
+		{
+			// Every attempt continues where the previous one stopped
+			const auto existing_size = std::filesystem::file_size(file, ec);
+			const auto offset = ec ? 0 : static_cast<size_t>(existing_size);
+
+			download.stream.open(file, std::ios::binary | std::ios::app);
+			if (!download.stream.is_open())
+			{
+				return false;
+			}
+
+			download.offset = offset;
+			helper.offset = offset;
+
+			curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(offset));
+
+			const auto result = curl_easy_perform(curl);
+			download.stream.close();
+
+			if (result == CURLE_OK)
+			{
+				long http_code = 0;
+				curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+				if (http_code >= 200)
+				{
+					return true;
+				}
+
+				throw std::runtime_error(
+					"Bad status code " + std::to_string(http_code) + " met while trying to download file " + url);
+			}
+
+			if (helper.exception)
+			{
+				std::rethrow_exception(helper.exception);
+			}
+
+			if (download.exception)
+			{
+				std::rethrow_exception(download.exception);
+			}
+
+			// The server ignored the range and sent the whole file, which curl rejects before
+			// any data is written, so the existing content is dropped and the file is restarted
+			if (result == CURLE_RANGE_ERROR && offset)
+			{
+				std::filesystem::remove(file, ec);
+				continue;
+			}
+
+			long http_code = 0;
+			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+			if (http_code > 0)
+			{
+				break;
+			}
+		}
+
+		return false;
+	}
+
 	std::future<std::optional<std::string>> get_data_async(const std::string& url, const headers& headers)
 	{
 		return std::async(std::launch::async, [url, headers]()
@@ -3,12 +3,24 @@
 #include <string>
 #include <optional>
 #include <future>
+#include <filesystem>
 
 namespace utils::http
 {
 	using headers = std::unordered_map<std::string, std::string>;
 
+	// Receives every chunk written to the file along with its offset in the file,
+	// an offset of 0 means the file was (re)started from scratch
+	using data_callback = std::function<void(size_t offset, const void* data, size_t length)>;
+
 	std::optional<std::string> get_data(const std::string& url, const headers& headers = {},
 	                                    const std::function<void(size_t)>& callback = {}, uint32_t retries = 2);
 	std::future<std::optional<std::string>> get_data_async(const std::string& url, const headers& headers = {});
+
+	// Streams the response into file. Existing file content is kept and only the remainder
+	// is requested using a Range header, the file is restarted when the server ignores it.
+	// A file that is already complete is left unchanged and reported as downloaded.
+	bool download_file(const std::string& url, const std::filesystem::path& file,
+	                   const data_callback& data_callback = {}, const headers& headers = {},
+	                   const std::function<void(size_t)>& callback = {}, uint32_t retries = 2);
 }
@@ -1,5 +1,6 @@
 #include "info_string.hpp"
-#include "string.hpp"
+
+#include <algorithm>
 
 namespace utils
 {
@@ -9,68 +10,191 @@ namespace utils
 	}
 
 	info_string::info_string(const char* buffer)
-		: info_string(std::string{buffer})
+		: info_string(std::string_view{buffer})
 	{
 	}
 
 	info_string::info_string(const std::string_view& buffer)
-		: info_string(std::string{buffer})
 	{
+		this->parse(buffer);
 	}
 
-
 	info_string::info_string(const std::basic_string_view<uint8_t>& buffer)
 		: info_string(std::string_view(reinterpret_cast<const char*>(buffer.data()), buffer.size()))
 	{
 	}
 
-	void info_string::set(const std::string& key, const std::string& value)
+	void info_string::set(const std::string_view key, const std::string_view value)
 	{
-		this->key_value_pairs_[key] = value;
-	}
+		const auto is_own_data = [this](const std::string_view data)
+		{
+			return data.data() >= this->buffer_.data() && data.data() < this->buffer_.data() + this->buffer_.size();
+		};
 
-	std::string info_string::get(const std::string& key) const
-	{
-		const auto value = this->key_value_pairs_.find(key);
-		if (value != this->key_value_pairs_.end())
+		// Appending may reallocate the buffer, so data referencing it has to be copied first
+		if (is_own_data(key) || is_own_data(value))
 		{
-			return value->second;
+			const std::string key_copy{key};
+			const std::string value_copy{value};
+			this->set(key_copy, value_copy);
+			return;
 		}
 
-		return {};
+		const auto value_offset = this->append(value);
+
+		const auto entry = std::ranges::lower_bound(this->entries_, key, {}, [this](const info_string::entry& e)
+		{
+			return this->get_key(e);
+		});
+
+		if (entry != this->entries_.end() && this->get_key(*entry) == key)
+		{
+			entry->value_offset = value_offset;
+			entry->value_length = value.size();
+			return;
+		}
+
+		const auto key_offset = this->append(key);
+		this->entries_.insert(entry, {key_offset, key.size(), value_offset, value.size()});
 	}
 
-	void info_string::parse(std::string buffer)
+	void info_string::remove(const std::string_view key)
 	{
-		if (buffer[0] == '\\')
+		const auto entry = this->find(key);
+		if (entry != this->entries_.end())
 		{
-			buffer = buffer.substr(1);
+			this->entries_.erase(entry);
 		}
+	}
 
-		const auto key_values = string::split(buffer, '\\');
-		for (size_t i = 0; !key_values.empty() && i < (key_values.size() - 1); i += 2)
+	std::string_view info_string::get(const std::string_view key) const
+	{
+		const auto entry = this->find(key);
+		if (entry != this->entries_.end())
 		{
-			const auto& key = key_values[i];
-			const auto& value = key_values[i + 1];
-
-			if (!this->key_value_pairs_.contains(key))
-			{
-				this->key_value_pairs_[key] = value;
-			}
+			return this->get_value(*entry);
 		}
+
+		return std::string_view{""};
 	}
 
 	std::string info_string::build() const
 	{
+		size_t size = 0;
+		for (const auto& entry : this->entries_)
+		{
+			size += entry.key_length + entry.value_length + 2;
+		}
+
 		std::string info_string;
-		for (const auto& [key, val] : this->key_value_pairs_)
+		info_string.reserve(size);
+
+		for (const auto& entry : this->entries_)
 		{
-			info_string.append("\\");
-			info_string.append(key);
-			info_string.append("\\");
-			info_string.append(val);
+			info_string.push_back('\\');
+			info_string.append(this->get_key(entry));
+			info_string.push_back('\\');
+			info_string.append(this->get_value(entry));
 		}
 
 		return info_string;
 	}
+
+	bool info_string::operator==(const info_string& other) const
+	{
+		return std::ranges::equal(this->entries_, other.entries_, [&](const entry& a, const entry& b)
+		{
+			return this->get_key(a) == other.get_key(b) && this->get_value(a) == other.get_value(b);
+		});
+	}
+
+	std::string_view info_string::get_key(const entry& entry) const
+	{
+		return {this->buffer_.data() + entry.key_offset, entry.key_length};
+	}
+
+	std::string_view info_string::get_value(const entry& entry) const
+	{
+		return {this->buffer_.data() + entry.value_offset, entry.value_length};
+	}
+
+	std::vector<info_string::entry>::const_iterator info_string::find(const std::string_view key) const
+	{
+		const auto entry = std::ranges::lower_bound(this->entries_, key, {}, [this](const info_string::entry& e)
+		{
+			return this->get_key(e);
+		});
+
+		if (entry != this->entries_.end() && this->get_key(*entry) == key)
+		{
+			return entry;
+		}
+
+		return this->entries_.end();
+	}
+
+	size_t info_string::append(const std::string_view data)
+	{
+		const auto offset = this->buffer_.size();
+		this->buffer_.append(data);
+		this->buffer_.push_back('\0');
+
+		return offset;
+	}
+
+	void info_string::parse(std::string_view buffer)
+	{
+		if (!buffer.empty() && buffer[0] == '\\')
+		{
+			buffer.remove_prefix(1);
+		}
+
+		// Separators are replaced by terminators, so every key and value is null-terminated in place
+		this->buffer_.assign(buffer);
+		this->buffer_.push_back('\0');
+		std::ranges::replace(this->buffer_, '\\', '\0');
+
+		this->entries_.clear();
+		this->entries_.reserve((static_cast<size_t>(std::ranges::count(buffer, '\\')) + 1) / 2);
+
+		size_t offset = 0;
+		const auto read_token = [&](size_t& token_offset, size_t& token_length)
+		{
+			if (offset >= buffer.size())
+			{
+				return false;
+			}
+
+			const auto end = std::min(buffer.find('\\', offset), buffer.size());
+
+			token_offset = offset;
+			token_length = end - offset;
+			offset = end + 1;
+			return true;
+		};
+
+		while (true)
+		{
+			entry entry{};
+			if (!read_token(entry.key_offset, entry.key_length) || !read_token(entry.value_offset, entry.value_length))
+			{
+				break;
+			}
+
+			this->entries_.emplace_back(entry);
+		}
+
+		// Keep the first occurrence of duplicate keys
+		std::ranges::stable_sort(this->entries_, {}, [this](const info_string::entry& e)
+		{
+			return this->get_key(e);
+		});
+
+		const auto duplicates = std::ranges::unique(this->entries_, {}, [this](const info_string::entry& e)
+		{
+			return this->get_key(e);
+		});
+
+		this->entries_.erase(duplicates.begin(), duplicates.end());
+	}
 }
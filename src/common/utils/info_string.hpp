@@ -1,7 +1,8 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 namespace utils
 {
@@ -14,13 +15,35 @@ namespace utils
 		explicit info_string(const std::string_view& buffer);
 		info_string(const std::basic_string_view<uint8_t>& buffer);
 
-		void set(const std::string& key, const std::string& value);
-		std::string get(const std::string& key) const;
+		void set(std::string_view key, std::string_view value);
+		void remove(std::string_view key);
+
+		// The returned view is null-terminated and stays valid until the next call to set
+		std::string_view get(std::string_view key) const;
 		std::string build() const;
 
+		bool operator==(const info_string& other) const;
+
 	private:
-		std::unordered_map<std::string, std::string> key_value_pairs_{};
+		struct entry
+		{
+			size_t key_offset;
+			size_t key_length;
+			size_t value_offset;
+			size_t value_length;
+		};
+
+		// Keys and values are stored null-terminated in a single buffer,
+		// entries reference them by offset and are kept sorted by key
+		std::string buffer_{};
+		std::vector<entry> entries_{};
+
+		std::string_view get_key(const entry& entry) const;
+		std::string_view get_value(const entry& entry) const;
+
+		std::vector<entry>::const_iterator find(std::string_view key) const;
+		size_t append(std::string_view data);
 
-		void parse(std::string buffer);
+		void parse(std::string_view buffer);
 	};
 }
@@ -1,10 +1,17 @@
 #include "memory.hpp"
 #include "nt.hpp"
 
+#include <algorithm>
+
 namespace utils
 {
 	memory::allocator memory::mem_allocator_;
 
+	memory::allocator::allocator(const size_t arena_block_size)
+		: arena_block_size_(arena_block_size)
+	{
+	}
+
 	memory::allocator::~allocator()
 	{
 		this->clear();
@@ -14,22 +21,36 @@ namespace utils
 	{
 		std::lock_guard _(this->mutex_);
 
-		for (const auto& data : this->pool_)
+		for (const auto& [data, length] : this->pool_)
 		{
 			memory::free(data);
 		}
 
+		for (const auto& block : this->arena_)
+		{
+			memory::free(block.data);
+		}
+
 		this->pool_.clear();
+		this->arena_.clear();
+
+		this->stats_.live_bytes = 0;
+		this->stats_.live_allocations = 0;
 	}
 
 	void memory::allocator::free(void* data)
 	{
 		std::lock_guard _(this->mutex_);
 
-		const auto j = std::find(this->pool_.begin(), this->pool_.end(), data);
+		// Arena allocations are only released all at once
+		const auto j = this->pool_.find(data);
 		if (j != this->pool_.end())
 		{
 			memory::free(data);
+
+			this->stats_.live_bytes -= j->second;
+			--this->stats_.live_allocations;
+
 			this->pool_.erase(j);
 		}
 	}
@@ -42,23 +63,21 @@ namespace utils
 	void* memory::allocator::allocate(const size_t length)
 	{
 		std::lock_guard _(this->mutex_);
-
-		const auto data = memory::allocate(length);
-		this->pool_.push_back(data);
-		return data;
+		return this->allocate_unlocked(length);
 	}
 
 	bool memory::allocator::empty() const
 	{
-		return this->pool_.empty();
+		std::lock_guard _(this->mutex_);
+		return this->stats_.live_allocations == 0;
 	}
 
 	char* memory::allocator::duplicate_string(const std::string& string)
 	{
 		std::lock_guard _(this->mutex_);
 
-		const auto data = memory::duplicate_string(string);
-		this->pool_.push_back(data);
+		const auto data = static_cast<char*>(this->allocate_unlocked(string.size() + 1));
+		std::memcpy(data, string.data(), string.size());
 		return data;
 	}
 
@@ -66,8 +85,94 @@ namespace utils
 	{
 		std::lock_guard _(this->mutex_);
 
-		const auto j = std::find(this->pool_.begin(), this->pool_.end(), data);
-		return j != this->pool_.end();
+		if (this->pool_.contains(const_cast<void*>(data)))
+		{
+			return true;
+		}
+
+		return this->find_arena(data);
+	}
+
+	bool memory::allocator::is_arena() const
+	{
+		return this->arena_block_size_ != 0;
+	}
+
+	memory::allocator_stats memory::allocator::get_stats() const
+	{
+		std::lock_guard _(this->mutex_);
+		return this->stats_;
+	}
+
+	void* memory::allocator::allocate_unlocked(const size_t length)
+	{
+		void* data{};
+		if (this->is_arena())
+		{
+			data = this->allocate_arena(length);
+		}
+		else
+		{
+			data = memory::allocate(length);
+			this->pool_.emplace(data, length);
+		}
+
+		this->stats_.live_bytes += length;
+		this->stats_.peak_bytes = std::max(this->stats_.peak_bytes, this->stats_.live_bytes);
+		++this->stats_.live_allocations;
+		++this->stats_.total_allocations;
+
+		return data;
+	}
+
+	void* memory::allocator::allocate_arena(const size_t length)
+	{
+		constexpr auto alignment = alignof(std::max_align_t);
+		const auto aligned_length = std::max((length + alignment - 1) & ~(alignment - 1), alignment);
+
+		// Oversized allocations get a dedicated block, pushed behind the current one so it stays in use
+		if (aligned_length > this->arena_block_size_)
+		{
+			arena_block block{};
+			block.data = static_cast<char*>(memory::allocate(aligned_length));
+			block.size = aligned_length;
+			block.used = aligned_length;
+
+			const auto position = this->arena_.empty() ? this->arena_.end() : std::prev(this->arena_.end());
+			this->arena_.insert(position, block);
+
+			return block.data;
+		}
+
+		if (this->arena_.empty() || this->arena_.back().size - this->arena_.back().used < aligned_length)
+		{
+			arena_block block{};
+			block.data = static_cast<char*>(memory::allocate(this->arena_block_size_));
+			block.size = this->arena_block_size_;
+
+			this->arena_.push_back(block);
+		}
+
+		auto& block = this->arena_.back();
+		auto* data = block.data + block.used;
+		block.used += aligned_length;
+
+		return data;
+	}
+
+	bool memory::allocator::find_arena(const void* data) const
+	{
+		const auto* pointer = static_cast<const char*>(data);
+
+		for (const auto& block : this->arena_)
+		{
+			if (pointer >= block.data && pointer < block.data + block.used)
+			{
+				return true;
+			}
+		}
+
+		return false;
 	}
 
 	void* memory::allocate(const size_t length)
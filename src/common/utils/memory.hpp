@@ -2,17 +2,34 @@
 
 #include <mutex>
 #include <vector>
+#include <unordered_map>
 
 namespace utils
 {
 	class memory final
 	{
 	public:
+		struct allocator_stats
+		{
+			size_t live_bytes{0};
+			size_t peak_bytes{0};
+			size_t live_allocations{0};
+			size_t total_allocations{0};
+		};
+
 		class allocator final
 		{
 		public:
+			allocator() = default;
+
+			// Arena mode: allocations are carved out of blocks of this size and only released by clear()
+			explicit allocator(size_t arena_block_size);
+
 			~allocator();
 
+			allocator(const allocator&) = delete;
+			allocator& operator=(const allocator&) = delete;
+
 			void clear();
 
 			void free(void* data);
@@ -39,9 +56,29 @@ namespace utils
 
 			bool find(const void* data);
 
+			bool is_arena() const;
+
+			allocator_stats get_stats() const;
+
 		private:
-			std::mutex mutex_;
-			std::vector<void*> pool_;
+			struct arena_block
+			{
+				char* data{};
+				size_t size{0};
+				size_t used{0};
+			};
+
+			mutable std::mutex mutex_;
+			std::unordered_map<void*, size_t> pool_;
+
+			size_t arena_block_size_{0};
+			std::vector<arena_block> arena_;
+
+			allocator_stats stats_{};
+
+			void* allocate_unlocked(size_t length);
+			void* allocate_arena(size_t length);
+			bool find_arena(const void* data) const;
 		};
 
 		static void* allocate(size_t length);
@@ -1,5 +1,7 @@
 #pragma once
 #include <thread>
+#include <atomic>
+#include <mutex>
 #include "nt.hpp"
 
 namespace utils::thread
@@ -17,6 +19,80 @@ namespace utils::thread
 		return t;
 	}
 
+	inline size_t get_optimal_thread_count(const size_t job_count)
+	{
+		const size_t cores = std::thread::hardware_concurrency();
+		return std::max(size_t(1), std::min(cores, job_count));
+	}
+
+	// Calls job for every index below count from up to thread_count threads and waits for all of them.
+	// The first exception thrown by a job stops the remaining jobs and is rethrown afterwards.
+	template <typename F>
+	void run_parallel(const size_t count, const size_t thread_count, F&& job)
+	{
+		if (!count)
+		{
+			return;
+		}
+
+		std::vector<std::thread> threads{};
+		std::atomic<size_t> current_index{0};
+
+		std::atomic_bool failed{false};
+		std::mutex exception_mutex{};
+		std::exception_ptr exception{};
+
+		for (size_t i = 0; i < std::max(size_t(1), std::min(thread_count, count)); ++i)
+		{
+			threads.emplace_back([&]()
+			{
+				while (!failed)
+				{
+					const auto index = current_index++;
+					if (index >= count)
+					{
+						break;
+					}
+
+					try
+					{
+						job(index);
+					}
+					catch (...)
+					{
+						std::lock_guard _(exception_mutex);
+						if (!exception)
+						{
+							exception = std::current_exception();
+						}
+
+						failed = true;
+						return;
+					}
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			if (thread.joinable())
+			{
+				thread.join();
+			}
+		}
+
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+
+	template <typename F>
+	void run_parallel(const size_t count, F&& job)
+	{
+		run_parallel(count, get_optimal_thread_count(count), std::forward<F>(job));
+	}
+
 	class handle
 	{
 	public: